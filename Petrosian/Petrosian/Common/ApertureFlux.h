@@ -0,0 +1,110 @@
+/**
+ * @file Petrosian/Common/ApertureFlux.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_COMMON_APERTUREFLUX_H
+#define _PETROSIAN_COMMON_APERTUREFLUX_H
+
+#include <SEFramework/Source/SourceFlags.h>
+#include <vector>
+
+#include "Petrosian/Common/EllipseAperture.h"
+#include "Petrosian/Common/ImageStamp.h"
+#include "Petrosian/Common/PixelOverlap.h"
+#include "Petrosian/Common/RowBlocks.h"
+
+namespace Petrosian {
+
+/**
+ * @struct ApertureFlux
+ * @brief
+ *  Result of integrating the pixels inside an aperture
+ */
+struct ApertureFlux {
+  double m_flux = 0., m_variance = 0.;
+  double m_total_area = 0., m_bad_area = 0.;
+  SourceXtractor::Flags m_flags = SourceXtractor::Flags::NONE;
+};
+
+/**
+ * Equivalent to SourceXtractor::measureFlux, but working on a private copy of the pixels,
+ * so it does not need to hold the global lock.
+ * @param aperture
+ *    The aperture to integrate, on the frame of the stamp
+ * @param stamp
+ *    Pixels and variance. It should cover the bounding box of the aperture, plus one pixel margin
+ *    when using symmetry, so mirrored pixels can be found.
+ * @param variance_threshold
+ *    Pixels with a variance above this value are considered bad
+ * @param use_symmetry
+ *    Replace bad pixels with their symmetric with respect to the centroid
+ * @param blocks
+ *    If the aperture is big enough, its rows are integrated by blocks, which may run in parallel
+ */
+ApertureFlux measureApertureFlux(const EllipseAperture& aperture, const ImageStamp& stamp,
+                                 SourceXtractor::SeFloat variance_threshold, bool use_symmetry,
+                                 const RowBlocks& blocks = RowBlocks());
+
+/**
+ * Same as above, but the pixels crossed by the edge of the aperture are weighted by the fraction
+ * that is inside, as given by overlap.
+ * @see PixelOverlap
+ */
+ApertureFlux measureApertureFlux(const EllipseAperture& aperture, const PixelOverlap& overlap,
+                                 const ImageStamp& stamp, SourceXtractor::SeFloat variance_threshold,
+                                 bool use_symmetry, const RowBlocks& blocks = RowBlocks());
+
+/**
+ * Measure several concentric apertures, which only differ on their radius, with a single pass over the pixels.
+ * @details
+ *  Each pixel is read once, and added to the ring between the smallest aperture that contains it and
+ *  the previous one. The flux within each aperture is then the cumulative sum of the rings, so K apertures
+ *  cost about the same as the biggest one alone.
+ * @param apertures
+ *    The apertures to integrate, sorted by increasing radius
+ * @param stamp
+ *    Pixels and variance. It should cover the bounding box of the biggest aperture, plus one pixel margin
+ *    when using symmetry
+ * @param variance_threshold
+ *    Pixels with a variance above this value are considered bad
+ * @param use_symmetry
+ *    Replace bad pixels with their symmetric with respect to the centroid
+ * @param fluxes
+ *    Set to the measurement of each aperture, in the same order
+ * @param blocks
+ *    If the biggest aperture is big enough, its rows are integrated by blocks, which may run in parallel
+ */
+void measureApertureFluxes(const std::vector<EllipseAperture>& apertures, const ImageStamp& stamp,
+                           SourceXtractor::SeFloat variance_threshold, bool use_symmetry,
+                           std::vector<ApertureFlux>& fluxes, const RowBlocks& blocks = RowBlocks());
+
+/**
+ * Same as above, but the pixels crossed by the edge of each aperture are weighted by the fraction
+ * that is inside, as given by the overlap of the same index.
+ */
+void measureApertureFluxes(const std::vector<EllipseAperture>& apertures, const std::vector<PixelOverlap>& overlaps,
+                           const ImageStamp& stamp, SourceXtractor::SeFloat variance_threshold, bool use_symmetry,
+                           std::vector<ApertureFlux>& fluxes, const RowBlocks& blocks = RowBlocks());
+
+}  // namespace Petrosian
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * @file Petrosian/Common/CheckImageSink.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#ifndef _PETROSIAN_COMMON_CHECKIMAGESINK_H
+#define _PETROSIAN_COMMON_CHECKIMAGESINK_H
+
+#include <SEFramework/Image/Image.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Petrosian/Common/EllipseAperture.h"
+
+namespace Petrosian {
+
+/**
+ * @class CheckImageSink
+ * @brief
+ *  Draws apertures on a check image, keeping the global lock as short as possible.
+ * @details
+ *  SourceXtractor::fillAperture must run while holding the global lock. It also visits every pixel of
+ *  the bounding box of the aperture, through virtual calls, and the check image has to be looked up
+ *  by name for every source.
+ *
+ *  This class looks up the check image only once. The apertures are rasterized into row spans by the
+ *  calling thread, without any lock, and queued. Whichever thread finds the queue idle becomes the
+ *  writer: it takes the global lock once for all the spans queued so far, including those added by
+ *  other threads meanwhile, until the queue is empty. Nothing is left pending once the last
+ *  source returns, so the check image is complete when SourceXtractor saves it.
+ */
+class CheckImageSink {
+
+public:
+
+  /**
+   * Constructor
+   * @param name
+   *    Name of the check image, as passed to SourceXtractor::CheckImages::getWriteableCheckImage
+   */
+  explicit CheckImageSink(std::string name);
+
+  CheckImageSink(const CheckImageSink&) = delete;
+  CheckImageSink& operator=(const CheckImageSink&) = delete;
+
+  /**
+   * Draw an elliptical aperture
+   * @param ellipse
+   *    The aperture, on the frame of the check image
+   * @param width
+   *    Width of the image, used to create the check image the first time
+   * @param height
+   *    Height of the image, used to create the check image the first time
+   * @param value
+   *    Value to write for the pixels inside the aperture
+   */
+  void fillAperture(const EllipseAperture& ellipse, int width, int height, float value);
+
+private:
+  /// Pixels [m_x0, m_x1) of row m_y are set to m_value
+  struct Span {
+    int m_y, m_x0, m_x1;
+    float m_value;
+  };
+
+  /// Write the queued spans until there are none left
+  void drain(int width, int height);
+
+  std::string m_name;
+  std::shared_ptr<SourceXtractor::WriteableImage<SourceXtractor::SeFloat>> m_image;
+
+  std::mutex m_mutex;
+  std::vector<Span> m_pending, m_writing;
+  bool m_draining = false;
+};
+
+}  // namespace Petrosian
+
+#endif
@@ -0,0 +1,163 @@
+/**
+ * @file Petrosian/Common/CumulativeProfile.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_COMMON_CUMULATIVEPROFILE_H
+#define _PETROSIAN_COMMON_CUMULATIVEPROFILE_H
+
+#include <algorithm>
+#include <vector>
+
+namespace Petrosian {
+
+/**
+ * @class CumulativeProfile
+ * @brief
+ *  Binned radial profile of a source, with the flux and area enclosed by any
+ *  elliptical radius available in constant time.
+ * @details
+ *  Pixels are histogrammed once, on bins uniformly spaced in \f$r^2\f$ (the
+ *  squared elliptical radius, in the same units as the aperture scale factor).
+ *  After accumulate() has been called, the enclosed flux and area within any
+ *  radius are obtained from the prefix sums, interpolating linearly inside the
+ *  bin where the radius falls.
+ *  This allows to evaluate as many rings as needed without going back to the pixels.
+ *  A profile can be reset() and filled again, reusing its storage, or extend()ed outwards,
+ *  keeping what has already been accumulated.
+ */
+class CumulativeProfile {
+
+public:
+
+  /**
+   * Constructor
+   * @param max_radius
+   *    Outermost radius covered by the profile. Pixels beyond are ignored.
+   * @param nbins
+   *    Number of bins in \f$r^2\f$
+   */
+  CumulativeProfile(double max_radius, unsigned nbins);
+
+  /**
+   * Default constructor. The profile is empty, and reset() must be called before using it
+   */
+  CumulativeProfile() : m_nbins(0), m_max_r2(0.), m_inv_bin_width(0.), m_accumulated(0), m_first_bin(1) {}
+
+  /**
+   * Clear the profile, and change its extent. Storage is only allocated if the number of bins grows
+   * @param max_radius
+   *    Outermost radius covered by the profile. Pixels beyond are ignored.
+   * @param nbins
+   *    Number of bins in \f$r^2\f$
+   */
+  void reset(double max_radius, unsigned nbins);
+
+  /**
+   * Clear the profile, and give it the same bins as another one, so it can be merge()d into it.
+   * Pixels are added as they would be to the other one, so none falls on the bins it has already accumulated
+   */
+  void reset(const CumulativeProfile& other);
+
+  /**
+   * Add the pixels of another profile with the same bins, which has not been accumulated yet.
+   * It must be empty on the bins this one has already accumulated
+   */
+  void merge(const CumulativeProfile& other);
+
+  /**
+   * Grow the profile outwards, adding bins of the same width. The bins already there are kept, and
+   * only pixels beyond the previous outermost radius should be added before accumulating again.
+   * Pixels on the previous edge whose radius falls short of it, due to rounding, go into the first new bin
+   * @param max_radius
+   *    New outermost radius. It is rounded up to a whole bin, so getMaxRadius() may be slightly greater
+   */
+  void extend(double max_radius);
+
+  /**
+   * Add a pixel to the profile
+   * @param r2
+   *    Squared elliptical radius of the pixel
+   * @param value
+   *    Pixel value
+   * @param area
+   *    Pixel area. It can be greater than 1 when adding a group of pixels at once
+   */
+  void add(double r2, double value, double area = 1.) {
+    if (r2 < m_max_r2) {
+      // Guard against rounding pushing r2 just below the limit into a bin past the end, and, once
+      // extended, just below the previous limit into a bin already accumulated
+      auto bin = std::min(std::max(static_cast<size_t>(r2 * m_inv_bin_width) + 1, m_first_bin), m_nbins);
+      m_flux[bin] += value;
+      m_area[bin] += area;
+    }
+  }
+
+  /**
+   * Turn the histogram into cumulative sums. Must be called once all pixels have been added,
+   * and before getFlux or getArea. After extend(), only the new bins are accumulated.
+   */
+  void accumulate();
+
+  /**
+   * @return The flux enclosed by the given radius
+   */
+  double getFlux(double radius) const;
+
+  /**
+   * @return The area, in pixels, enclosed by the given radius
+   */
+  double getArea(double radius) const;
+
+  /**
+   * Inverse of getFlux: find where the growth curve reaches a given flux
+   * @param flux
+   *    Flux to enclose
+   * @param min_radius
+   *    The search starts at this radius
+   * @param max_radius
+   *    The search stops at this radius
+   * @return The smallest radius between min_radius and max_radius that encloses the flux, or
+   *    max_radius if none does
+   */
+  double getRadius(double flux, double min_radius, double max_radius) const;
+
+  /**
+   * @return The outermost radius covered by the profile
+   */
+  double getMaxRadius() const;
+
+private:
+  size_t m_nbins;
+  double m_max_r2, m_inv_bin_width;
+  // Element 0 is always 0, element i + 1 holds bin i (or, once accumulated, the sum of bins 0 to i)
+  std::vector<double> m_flux, m_area;
+  // Elements below this are already cumulative sums
+  size_t m_accumulated;
+  // First element add() writes to. It is past the accumulated ones
+  size_t m_first_bin;
+
+  double interpolate(const std::vector<double>& cumulative, double radius) const;
+};
+
+}  // namespace Petrosian
+
+#endif
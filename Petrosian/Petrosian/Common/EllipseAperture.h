@@ -0,0 +1,137 @@
+/**
+ * @file Petrosian/Common/EllipseAperture.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#ifndef _PETROSIAN_COMMON_ELLIPSEAPERTURE_H
+#define _PETROSIAN_COMMON_ELLIPSEAPERTURE_H
+
+#include <SEFramework/Aperture/Aperture.h>
+#include <SEUtils/PixelCoordinate.h>
+#include <tuple>
+
+namespace Petrosian {
+
+/**
+ * @class EllipseAperture
+ * @brief
+ *  Elliptical aperture \f$c_{xx} dx^2 + c_{yy} dy^2 + c_{xy} dx dy < R^2\f$, centered on a given point,
+ *  on the frame where it is measured.
+ * @details
+ *  SourceXtractor measures on other frames wrapping a SourceXtractor::EllipticalAperture into a
+ *  SourceXtractor::TransformedAperture, so every pixel test goes through the Jacobian and two virtual calls.
+ *  A linear transformation of an ellipse is still an ellipse, so here the Jacobian is folded into the
+ *  coefficients once, and the pixel test is a quadratic form that can be inlined.
+ *  As with SourceXtractor::EllipticalAperture, a pixel is inside if its center is.
+ */
+class EllipseAperture {
+
+public:
+
+  /**
+   * Constructor
+   * @param cxx
+   *    Ellipse coefficient, on this frame
+   * @param cyy
+   *    Ellipse coefficient, on this frame
+   * @param cxy
+   *    Ellipse coefficient, on this frame
+   * @param radius
+   *    Scale factor of the ellipse (R)
+   * @param centroid_x
+   *    Center of the ellipse
+   * @param centroid_y
+   *    Center of the ellipse
+   */
+  EllipseAperture(double cxx, double cyy, double cxy, double radius, double centroid_x, double centroid_y);
+
+  /**
+   * Build the aperture on a measurement frame from an ellipse on the detection frame
+   * @param cxx
+   *    Ellipse coefficient, on the detection frame
+   * @param cyy
+   *    Ellipse coefficient, on the detection frame
+   * @param cxy
+   *    Ellipse coefficient, on the detection frame
+   * @param radius
+   *    Scale factor of the ellipse (R)
+   * @param jacobian
+   *    Jacobian between the detection and the measurement frames, as given by SourceXtractor::JacobianSource
+   * @param centroid_x
+   *    Center of the ellipse on the measurement frame
+   * @param centroid_y
+   *    Center of the ellipse on the measurement frame
+   */
+  static EllipseAperture transform(double cxx, double cyy, double cxy, double radius,
+                                   const std::tuple<double, double, double, double>& jacobian,
+                                   double centroid_x, double centroid_y);
+
+  double getCxx() const {
+    return m_cxx;
+  }
+
+  double getCyy() const {
+    return m_cyy;
+  }
+
+  double getCxy() const {
+    return m_cxy;
+  }
+
+  double getRadius() const {
+    return m_radius;
+  }
+
+  double getCentroidX() const {
+    return m_centroid_x;
+  }
+
+  double getCentroidY() const {
+    return m_centroid_y;
+  }
+
+  /// @return The left hand side of the ellipse equation for the pixel
+  double getRadiusSquared(int x, int y) const {
+    double dx = x - m_centroid_x;
+    double dy = y - m_centroid_y;
+    return m_cxx * dx * dx + m_cyy * dy * dy + m_cxy * dx * dy;
+  }
+
+  /// @return 1 if the center of the pixel is inside the ellipse, 0 otherwise
+  double getArea(int x, int y) const {
+    return getRadiusSquared(x, y) < m_r2 ? 1. : 0.;
+  }
+
+  /// @return Top left corner of the bounding box of the ellipse, including pixels only partially covered
+  SourceXtractor::PixelCoordinate getMinPixel() const;
+
+  /// @return Bottom right corner of the bounding box of the ellipse, including pixels only partially covered
+  SourceXtractor::PixelCoordinate getMaxPixel() const;
+
+private:
+  double m_cxx, m_cyy, m_cxy, m_radius, m_r2;
+  double m_centroid_x, m_centroid_y;
+};
+
+}  // namespace Petrosian
+
+#endif
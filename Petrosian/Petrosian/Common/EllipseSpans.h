@@ -0,0 +1,117 @@
+/**
+ * @file Petrosian/Common/EllipseSpans.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_COMMON_ELLIPSESPANS_H
+#define _PETROSIAN_COMMON_ELLIPSESPANS_H
+
+#include <SEUtils/PixelCoordinate.h>
+
+namespace Petrosian {
+
+/**
+ * @struct PixelSpan
+ * @brief
+ *  Range [m_x0, m_x1) of pixels of a row
+ */
+struct PixelSpan {
+  int m_x0, m_x1;
+
+  bool empty() const {
+    return m_x1 <= m_x0;
+  }
+};
+
+/**
+ * @class EllipseSpans
+ * @brief
+ *  Rasterizes an ellipse \f$c_{xx} dx^2 + c_{yy} dy^2 + c_{xy} dx dy \le R^2\f$ into row spans,
+ *  optionally clipped to a region (i.e. the image).
+ * @details
+ *  A pixel belongs to the ellipse if its center does. Instead of visiting every pixel of the
+ *  bounding box, and checking if it is inside the image and inside the ellipse, loops can iterate
+ *  from getMinY() to getMaxY() (included) and, for each row, over the pixels returned by getSpan().
+ */
+class EllipseSpans {
+
+public:
+
+  /**
+   * Constructor
+   * @param cxx
+   *    Ellipse coefficient
+   * @param cyy
+   *    Ellipse coefficient
+   * @param cxy
+   *    Ellipse coefficient
+   * @param radius
+   *    Scale factor of the ellipse (R)
+   * @param centroid_x
+   *    Center of the ellipse
+   * @param centroid_y
+   *    Center of the ellipse
+   */
+  EllipseSpans(double cxx, double cyy, double cxy, double radius, double centroid_x, double centroid_y);
+
+  /**
+   * Restrict the rows and spans to the given region
+   * @param min_pixel
+   *    Top left corner of the region (included)
+   * @param max_pixel
+   *    Bottom right corner of the region (included)
+   */
+  void clip(const SourceXtractor::PixelCoordinate& min_pixel, const SourceXtractor::PixelCoordinate& max_pixel);
+
+  /// @return First row covered by the ellipse
+  int getMinY() const {
+    return m_min_y;
+  }
+
+  /// @return Last row covered by the ellipse
+  int getMaxY() const {
+    return m_max_y;
+  }
+
+  /**
+   * @return The pixels of the row y whose center falls within the ellipse
+   */
+  PixelSpan getSpan(int y) const;
+
+  /**
+   * @return Top left corner of the bounding box of the ellipse (clipped, if requested)
+   */
+  SourceXtractor::PixelCoordinate getMinPixel() const;
+
+  /**
+   * @return Bottom right corner of the bounding box of the ellipse (clipped, if requested)
+   */
+  SourceXtractor::PixelCoordinate getMaxPixel() const;
+
+private:
+  double m_cxx, m_cxy, m_cyy, m_r2;
+  double m_centroid_x, m_centroid_y;
+  int m_min_x, m_max_x, m_min_y, m_max_y;
+};
+
+}  // namespace Petrosian
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * @file Petrosian/Common/GlobalLock.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_COMMON_GLOBALLOCK_H
+#define _PETROSIAN_COMMON_GLOBALLOCK_H
+
+#include <cstdint>
+#include <mutex>
+
+namespace Petrosian {
+
+/**
+ * @class GlobalLock
+ * @brief
+ *  Scoped lock over SourceXtractor::MultithreadedMeasurement::g_global_mutex that keeps
+ *  track of how often the plugin had to wait for it.
+ * @details
+ *  The global mutex must be held while accessing directly the frame images. Tasks should
+ *  keep the scope of this lock as short as possible: just copy the pixels they need,
+ *  and release it before doing any computation.
+ */
+class GlobalLock {
+
+public:
+
+  /**
+   * Acquire the global mutex, blocking if needed
+   */
+  GlobalLock();
+
+  /**
+   * Release the global mutex
+   */
+  ~GlobalLock() = default;
+
+  /**
+   * @return How long, in nanoseconds, this acquisition had to wait for the mutex. 0 if it was free
+   */
+  uint64_t getWaitTime() const {
+    return m_wait_time;
+  }
+
+  /**
+   * @return How many times the lock has been acquired by the plugin
+   */
+  static uint64_t getAcquisitions();
+
+  /**
+   * @return How many of those acquisitions found the mutex held by some other thread
+   */
+  static uint64_t getContentions();
+
+private:
+  std::unique_lock<std::recursive_mutex> m_lock;
+  uint64_t m_wait_time;
+};
+
+}  // namespace Petrosian
+
+#endif
@@ -0,0 +1,86 @@
+/**
+ * @file Petrosian/Common/GroupStamps.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#ifndef _PETROSIAN_COMMON_GROUPSTAMPS_H
+#define _PETROSIAN_COMMON_GROUPSTAMPS_H
+
+#include "Petrosian/Common/ImageStamp.h"
+
+namespace Petrosian {
+
+/**
+ * @class GroupStamps
+ * @brief
+ *  Stamps for all the members of a source group, copied in one go.
+ * @details
+ *  Blended sources overlap, so copying a stamp per source would read the same pixels several times.
+ *  Instead, the region required by each member is registered with add(), and copy() reads, under a
+ *  single acquisition of the global lock, the bounding box of all of them.
+ *  If the members are too spread for their bounding box to be worth it - i.e. two
+ *  distant sources joined by a faint bridge -, each gets its own stamp instead.
+ *  After clear(), the instance can be used for another group, reusing the memory of the stamps.
+ */
+class GroupStamps {
+
+public:
+
+  /**
+   * Forget the registered regions and the stamps, keeping their storage
+   */
+  void clear();
+
+  /**
+   * Register the region required by the next member of the group
+   * @param min_pixel
+   *    Top left corner of the region (included)
+   * @param max_pixel
+   *    Bottom right corner of the region (included)
+   */
+  void add(const SourceXtractor::PixelCoordinate& min_pixel, const SourceXtractor::PixelCoordinate& max_pixel);
+
+  /**
+   * Copy the pixels. The caller must hold the global lock.
+   * @see ImageStamp
+   */
+  void copy(const std::shared_ptr<SourceXtractor::Image<SourceXtractor::SeFloat>>& image,
+            const std::shared_ptr<SourceXtractor::Image<SourceXtractor::SeFloat>>& variance,
+            const std::shared_ptr<SourceXtractor::Image<SourceXtractor::SeFloat>>& thresholded = nullptr);
+
+  /**
+   * @return The stamp for the i-th registered member. It contains, at least, the region given to add()
+   */
+  const ImageStamp& getStamp(size_t i) const {
+    return m_nstamps == 1 ? m_stamps.front() : m_stamps[i];
+  }
+
+private:
+  std::vector<SourceXtractor::PixelCoordinate> m_min_pixels, m_max_pixels;
+  /// Only the first m_nstamps are in use, the rest are kept for their storage
+  std::vector<ImageStamp> m_stamps;
+  size_t m_nstamps = 0;
+};
+
+}  // namespace Petrosian
+
+#endif
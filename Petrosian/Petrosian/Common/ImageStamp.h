@@ -0,0 +1,171 @@
+/**
+ * @file Petrosian/Common/ImageStamp.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_COMMON_IMAGESTAMP_H
+#define _PETROSIAN_COMMON_IMAGESTAMP_H
+
+#include <memory>
+#include <vector>
+
+#include <SEFramework/Image/Image.h>
+#include <SEUtils/PixelCoordinate.h>
+#include <SEUtils/Types.h>
+
+namespace Petrosian {
+
+/**
+ * @class ImageStamp
+ * @brief
+ *  Private copy of a rectangular region of an image, its variance map and, optionally,
+ *  its thresholded image.
+ * @details
+ *  Frame images can not be read concurrently, so the copy has to be done while holding
+ *  the global lock (see GlobalLock). Once done, the stamp can be used freely from the
+ *  owning thread.
+ *  Each plane is fetched with a single chunk request, and stored row-major, so hot loops
+ *  can iterate directly over the rows returned by getImageRow and friends.
+ *  The region is clipped to the image, so any pixel of the stamp is a valid image pixel.
+ *  All accessors use image (not stamp) coordinates.
+ *  A stamp can be copied again from a different region with copy(), reusing its storage, so
+ *  a long lived (i.e. thread local) stamp does not allocate once it is big enough.
+ */
+class ImageStamp {
+
+public:
+
+  /**
+   * Constructor. Copies the pixels.
+   * @param image
+   *    Image from which to copy
+   * @param variance
+   *    Variance map. Can be nullptr, in which case the variance is assumed to be 1
+   * @param min_pixel
+   *    Top left corner of the region to copy (included)
+   * @param max_pixel
+   *    Bottom right corner of the region to copy (included)
+   * @param thresholded
+   *    Thresholded image, used to identify pixels that belong to neighbours. Can be nullptr.
+   */
+  ImageStamp(const std::shared_ptr<SourceXtractor::Image<SourceXtractor::SeFloat>>& image,
+             const std::shared_ptr<SourceXtractor::Image<SourceXtractor::SeFloat>>& variance,
+             const SourceXtractor::PixelCoordinate& min_pixel, const SourceXtractor::PixelCoordinate& max_pixel,
+             const std::shared_ptr<SourceXtractor::Image<SourceXtractor::SeFloat>>& thresholded = nullptr);
+
+  /**
+   * Default constructor. The stamp is empty until copy() is called
+   */
+  ImageStamp();
+
+  /**
+   * Replace the contents of the stamp with the pixels of the given region.
+   * The parameters are those of the constructor.
+   */
+  void copy(const std::shared_ptr<SourceXtractor::Image<SourceXtractor::SeFloat>>& image,
+            const std::shared_ptr<SourceXtractor::Image<SourceXtractor::SeFloat>>& variance,
+            const SourceXtractor::PixelCoordinate& min_pixel, const SourceXtractor::PixelCoordinate& max_pixel,
+            const std::shared_ptr<SourceXtractor::Image<SourceXtractor::SeFloat>>& thresholded = nullptr);
+
+  /// @return Leftmost column covered by the stamp
+  int getMinX() const {
+    return m_min_x;
+  }
+
+  /// @return Topmost row covered by the stamp
+  int getMinY() const {
+    return m_min_y;
+  }
+
+  /// @return Width of the stamp. It may be 0 if the region falls outside the image
+  int getWidth() const {
+    return m_width;
+  }
+
+  /// @return Height of the stamp. It may be 0 if the region falls outside the image
+  int getHeight() const {
+    return m_height;
+  }
+
+  /// @return Width of the image from which the stamp has been copied
+  int getImageWidth() const {
+    return m_image_width;
+  }
+
+  /// @return Height of the image from which the stamp has been copied
+  int getImageHeight() const {
+    return m_image_height;
+  }
+
+  /// @return true if the pixel is within the image
+  bool isInsideImage(int x, int y) const {
+    return x >= 0 && y >= 0 && x < m_image_width && y < m_image_height;
+  }
+
+  /// @return true if the pixel has been copied into the stamp
+  bool contains(int x, int y) const {
+    return x >= m_min_x && y >= m_min_y && x < m_min_x + m_width && y < m_min_y + m_height;
+  }
+
+  /// @return true if the stamp has a copy of the variance map
+  bool hasVariance() const {
+    return !m_variance.empty();
+  }
+
+  /// @return true if the stamp has a copy of the thresholded image
+  bool hasThresholded() const {
+    return !m_thresholded.empty();
+  }
+
+  /// @return Pointer to the first stamp pixel of the image row y
+  const SourceXtractor::SeFloat* getImageRow(int y) const {
+    return m_image.data() + (y - m_min_y) * m_width;
+  }
+
+  /// @return Pointer to the first stamp pixel of the variance row y. Only valid if hasVariance()
+  const SourceXtractor::SeFloat* getVarianceRow(int y) const {
+    return m_variance.data() + (y - m_min_y) * m_width;
+  }
+
+  /// @return Pointer to the first stamp pixel of the thresholded row y. Only valid if hasThresholded()
+  const SourceXtractor::SeFloat* getThresholdedRow(int y) const {
+    return m_thresholded.data() + (y - m_min_y) * m_width;
+  }
+
+  /// @return The value of the pixel. It must be contained in the stamp
+  SourceXtractor::SeFloat getValue(int x, int y) const {
+    return m_image[(x - m_min_x) + (y - m_min_y) * m_width];
+  }
+
+  /// @return The variance of the pixel, or 1 if there is no variance map. It must be contained in the stamp
+  SourceXtractor::SeFloat getVariance(int x, int y) const {
+    return m_variance.empty() ? 1 : m_variance[(x - m_min_x) + (y - m_min_y) * m_width];
+  }
+
+private:
+  int m_min_x, m_min_y, m_width, m_height;
+  int m_image_width, m_image_height;
+  std::vector<SourceXtractor::SeFloat> m_image, m_variance, m_thresholded;
+};
+
+}  // namespace Petrosian
+
+#endif
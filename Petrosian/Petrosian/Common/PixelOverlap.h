@@ -0,0 +1,94 @@
+/**
+ * @file Petrosian/Common/PixelOverlap.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#ifndef _PETROSIAN_COMMON_PIXELOVERLAP_H
+#define _PETROSIAN_COMMON_PIXELOVERLAP_H
+
+#include "Petrosian/Common/EllipseAperture.h"
+
+namespace Petrosian {
+
+/**
+ * @class PixelOverlap
+ * @brief
+ *  Fraction of each pixel covered by an ellipse \f$c_{xx} dx^2 + c_{yy} dy^2 + c_{xy} dx dy \le R^2\f$
+ * @details
+ *  SourceXtractor apertures count a pixel as fully inside or outside depending on its center,
+ *  which makes the flux of small apertures jump as the centroid moves.
+ *
+ *  Pixels far enough from the edge are still fully inside or outside. For the others, the edge is
+ *  replaced by its tangent line, which is accurate as long as the ellipse is much bigger than a pixel.
+ *  The area of a unit square on one side of a line only depends on the direction of the line, and on its
+ *  distance to the center of the square, so it is computed once for all ellipses, and looked up from a table.
+ *
+ *  When the edge curves too much within a pixel (small or very elongated ellipses), the pixels crossed
+ *  by the edge are split into sub-pixels, and the approximation is done for each of them.
+ */
+class PixelOverlap {
+
+public:
+
+  /**
+   * Constructor
+   * @param ellipse
+   *    The ellipse, on the frame being measured
+   */
+  explicit PixelOverlap(const EllipseAperture& ellipse);
+
+  /**
+   * @return The fraction of the pixel (x, y) inside the ellipse, between 0 and 1
+   */
+  double getArea(int x, int y) const {
+    double dx = x - m_centroid_x;
+    double dy = y - m_centroid_y;
+    double r2 = m_cxx * dx * dx + m_cyy * dy * dy + m_cxy * dx * dy;
+
+    // Most pixels are well inside or outside
+    if (r2 < m_inner_r2) {
+      return 1.;
+    }
+    if (r2 >= m_outer_r2) {
+      return 0.;
+    }
+    return getBoundaryArea(dx, dy);
+  }
+
+private:
+  /// Fraction of the pixel at (dx, dy) from the center, for pixels that may be crossed by the edge
+  double getBoundaryArea(double dx, double dy) const;
+
+  /// Fraction of the square of side scale, centered at (dx, dy) from the center, inside the ellipse
+  double getEdgeArea(double dx, double dy, double scale) const;
+
+  double m_cxx, m_cyy, m_cxy, m_radius;
+  double m_centroid_x, m_centroid_y;
+  /// Below (above) these values of the radius squared, the whole pixel is inside (outside)
+  double m_inner_r2, m_outer_r2;
+  /// Pixels crossed by the edge are split in m_subdivision x m_subdivision sub-pixels
+  int m_subdivision;
+};
+
+}  // namespace Petrosian
+
+#endif
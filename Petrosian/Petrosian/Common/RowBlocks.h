@@ -0,0 +1,123 @@
+/**
+ * @file Petrosian/Common/RowBlocks.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_COMMON_ROWBLOCKS_H
+#define _PETROSIAN_COMMON_ROWBLOCKS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Petrosian/Common/ThreadPool.h"
+
+namespace Petrosian {
+
+// Height, in rows, of each block
+static const int PETRO_BLOCK_ROWS = 64;
+
+/**
+ * @class RowBlocks
+ * @brief
+ *  Splits the rows of big stamps into blocks, which are reduced independently and then combined.
+ * @details
+ *  A single huge source can take longer than thousands of normal ones, leaving the other threads idle
+ *  at the end of a run. Its rows are split into blocks of fixed height, each one reduced into its own
+ *  partial result, on a ThreadPool if there is one: its threads claim the blocks one at a time as they
+ *  get free, so a slow block does not hold back the rest.
+ *  The partial results are then combined pairwise, always in the same order. The result depends only on
+ *  the stamp, and not on the number of threads, nor on which one reduced each block.
+ *  Stamps up to the configured area are not split, and are reduced as before.
+ */
+class RowBlocks {
+
+public:
+
+  /**
+   * Default constructor. Nothing is split
+   */
+  RowBlocks() : m_min_area(0) {}
+
+  /**
+   * Constructor
+   * @param min_area
+   *    Stamps with more pixels than this are split. 0 disables it
+   * @param pool
+   *    Pool the blocks are reduced on. If nullptr, they are reduced one after the other by the calling thread
+   */
+  RowBlocks(int min_area, std::shared_ptr<ThreadPool> pool) : m_min_area(min_area), m_pool(std::move(pool)) {}
+
+  /// @return true if a region with the given size is to be split
+  bool applies(int width, int height) const {
+    return m_min_area > 0 && width > 0 && height > 0 && static_cast<int64_t>(width) * height > m_min_area;
+  }
+
+  /**
+   * Reduce the rows between min_y and max_y (included), block by block
+   * @param partials
+   *    Partial result of each block. It only grows, so its elements are reused from call to call.
+   *    On return, the first one holds the combined result
+   * @param reduce_rows
+   *    reduce_rows(partial, y0, y1) reduces the rows between y0 and y1 (included) into partial, which
+   *    holds whatever a previous call left there. It may run on any thread of the pool
+   * @param combine
+   *    combine(a, b) adds b into a
+   */
+  template <typename T, typename ReduceFunction, typename CombineFunction>
+  void reduce(int min_y, int max_y, std::vector<T>& partials, const ReduceFunction& reduce_rows,
+              const CombineFunction& combine) const {
+    size_t nblocks = max_y >= min_y ? (max_y - min_y) / PETRO_BLOCK_ROWS + 1 : 1;
+    if (partials.size() < nblocks) {
+      partials.resize(nblocks);
+    }
+
+    std::function<void(size_t)> reduce_block = [min_y, max_y, &partials, &reduce_rows](size_t i) {
+      int y0 = min_y + static_cast<int>(i) * PETRO_BLOCK_ROWS;
+      reduce_rows(partials[i], y0, std::min(y0 + PETRO_BLOCK_ROWS - 1, max_y));
+    };
+    if (m_pool) {
+      m_pool->parallelFor(nblocks, reduce_block);
+    }
+    else {
+      for (size_t i = 0; i < nblocks; ++i) {
+        reduce_block(i);
+      }
+    }
+
+    // Pairwise, as a binary tree over the blocks, so the rounding errors do not pile up either
+    for (size_t stride = 1; stride < nblocks; stride *= 2) {
+      for (size_t i = 0; i + stride < nblocks; i += 2 * stride) {
+        combine(partials[i], partials[i + stride]);
+      }
+    }
+  }
+
+private:
+  int m_min_area;
+  std::shared_ptr<ThreadPool> m_pool;
+};
+
+}  // namespace Petrosian
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * @file Petrosian/Common/RowKernel.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_COMMON_ROWKERNEL_H
+#define _PETROSIAN_COMMON_ROWKERNEL_H
+
+#include <vector>
+
+namespace Petrosian {
+
+/**
+ * @struct EllipseRow
+ * @brief
+ *  Terms of the elliptical radius \f$r^2 = c_{xx} dx^2 + c_{yy} dy^2 + c_{xy} dx dy\f$
+ *  that are constant along a row of pixels
+ */
+struct EllipseRow {
+  /// Horizontal offset between the first pixel of the row and the centroid
+  float dx0;
+  /// \f$c_{xx}\f$
+  float cxx;
+  /// \f$c_{xy} dy\f$
+  float cxy_dy;
+  /// \f$c_{yy} dy^2\f$
+  float r2_row;
+};
+
+/**
+ * Compute the squared elliptical radius of a row of pixels. They are masked by the caller, with the stamp mask.
+ * @details
+ *  The implementation is chosen at run time depending on the instruction sets supported
+ *  by the CPU (AVX-512, AVX2, SSE4.1), falling back to evaluateRowRadiusScalar.
+ *  All implementations give exactly the same results.
+ * @param row
+ *    Geometry of the row
+ * @param n
+ *    Number of pixels in the row
+ * @param r2
+ *    Output: squared elliptical radius of each pixel
+ */
+void evaluateRowRadius(const EllipseRow& row, int n, float* r2);
+
+/**
+ * Scalar implementation of evaluateRowRadius, used as a fallback and as the reference
+ */
+void evaluateRowRadiusScalar(const EllipseRow& row, int n, float* r2);
+
+/**
+ * @return The name of the instruction set used by evaluateRowRadius
+ */
+const char* getRowKernelName();
+
+/// Signature shared by all implementations of evaluateRowRadius
+using RowRadiusFunction = void (*)(const EllipseRow&, int, float*);
+
+/**
+ * @struct RowKernel
+ * @brief
+ *  Implementation of evaluateRowRadius for one instruction set
+ */
+struct RowKernel {
+  const char* m_name;
+  RowRadiusFunction m_radius;
+};
+
+/**
+ * @return The implementations the CPU can run, the most capable first. evaluateRowRadius uses
+ *    the first one, and the last one is always the scalar
+ */
+std::vector<RowKernel> getRowKernels();
+
+}  // namespace Petrosian
+
+#endif
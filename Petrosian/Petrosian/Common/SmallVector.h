@@ -0,0 +1,133 @@
+/**
+ * @file Petrosian/Common/SmallVector.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#ifndef _PETROSIAN_COMMON_SMALLVECTOR_H
+#define _PETROSIAN_COMMON_SMALLVECTOR_H
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace Petrosian {
+
+/**
+ * @class ArrayView
+ * @brief
+ *  Read-only view of a contiguous sequence of values owned by someone else.
+ *  It is only valid for as long as the owner is alive and not modified.
+ */
+template <typename T>
+class ArrayView {
+
+public:
+
+  ArrayView(const T* begin, std::size_t size) : m_begin(begin), m_end(begin + size) {}
+
+  const T* begin() const {
+    return m_begin;
+  }
+
+  const T* end() const {
+    return m_end;
+  }
+
+  std::size_t size() const {
+    return m_end - m_begin;
+  }
+
+  const T& operator[](std::size_t i) const {
+    return m_begin[i];
+  }
+
+  /// Copy into a vector of any type constructible from T
+  template <typename U = T>
+  std::vector<U> toVector() const {
+    return std::vector<U>(m_begin, m_end);
+  }
+
+private:
+  const T* m_begin;
+  const T* m_end;
+};
+
+/**
+ * @class SmallVector
+ * @brief
+ *  Fixed size sequence of values that lives inline, without allocating, if it has
+ *  at most N elements, and on the heap otherwise.
+ * @details
+ *  It is meant for per-source data that has one value per band: the number of bands
+ *  is small for most runs, and a separate allocation for each source would cost more
+ *  than the values themselves.
+ */
+template <typename T, std::size_t N>
+class SmallVector {
+
+public:
+
+  /**
+   * Constructor
+   * @param size
+   *    Number of elements, value-initialized
+   */
+  explicit SmallVector(std::size_t size = 0) : m_size(size), m_inline() {
+    if (m_size > N) {
+      m_heap.resize(m_size);
+    }
+  }
+
+  T* data() {
+    return m_size <= N ? m_inline.data() : m_heap.data();
+  }
+
+  const T* data() const {
+    return m_size <= N ? m_inline.data() : m_heap.data();
+  }
+
+  std::size_t size() const {
+    return m_size;
+  }
+
+  T& operator[](std::size_t i) {
+    return data()[i];
+  }
+
+  const T& operator[](std::size_t i) const {
+    return data()[i];
+  }
+
+  /// @return A view of the elements [offset, offset + size)
+  ArrayView<T> view(std::size_t offset, std::size_t size) const {
+    return ArrayView<T>(data() + offset, size);
+  }
+
+private:
+  std::size_t m_size;
+  std::array<T, N> m_inline;
+  std::vector<T> m_heap;
+};
+
+}  // namespace Petrosian
+
+#endif
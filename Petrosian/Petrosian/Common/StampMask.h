@@ -0,0 +1,147 @@
+/**
+ * @file Petrosian/Common/StampMask.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_COMMON_STAMPMASK_H
+#define _PETROSIAN_COMMON_STAMPMASK_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Petrosian/Common/ImageStamp.h"
+
+namespace Petrosian {
+
+/**
+ * @struct MaskRow
+ * @brief
+ *  One row of a StampMask plane, addressed with image coordinates
+ */
+struct MaskRow {
+  const uint64_t* m_words;
+  int m_min_x;
+
+  /// @return true if the bit of the pixel at column x is set. It must be within the mask
+  bool test(int x) const {
+    unsigned i = x - m_min_x;
+    return (m_words[i / 64] >> (i % 64)) & 1u;
+  }
+};
+
+/**
+ * @class StampMask
+ * @brief
+ *  Which pixels of a region of an ImageStamp can be used for a given source, packed one bit per pixel.
+ * @details
+ *  A pixel is usable if its variance is below the threshold and it does not belong to a neighbour:
+ *  it is above the detection threshold - as given by the thresholded image of the stamp - but it is
+ *  not one of the pixels of the source.
+ *  The mask is built once per source, so hot loops test one bit instead of comparing the variance,
+ *  and can not forget about the neighbours. Pixels of neighbours are kept on their own plane too,
+ *  so they can be found without visiting the whole region.
+ *  As ImageStamp, it can be built again for another source, reusing its storage.
+ */
+class StampMask {
+
+public:
+
+  /**
+   * Build the mask
+   * @param stamp
+   *    Stamp the mask is for
+   * @param variance_threshold
+   *    Pixels with a variance not below this value are not usable
+   * @param min_pixel, max_pixel
+   *    Region covered by the mask (included). It is clipped to the stamp
+   * @param source_pixels
+   *    Pixels detected as part of the source. If nullptr, or if the stamp has no thresholded image,
+   *    there are no neighbours
+   */
+  void build(const ImageStamp& stamp, float variance_threshold, const SourceXtractor::PixelCoordinate& min_pixel,
+             const SourceXtractor::PixelCoordinate& max_pixel,
+             const std::vector<SourceXtractor::PixelCoordinate>* source_pixels);
+
+  /// @return Leftmost column covered by the mask
+  int getMinX() const {
+    return m_min_x;
+  }
+
+  /// @return Topmost row covered by the mask
+  int getMinY() const {
+    return m_min_y;
+  }
+
+  /// @return Width of the mask. It may be 0 if the region falls outside the stamp
+  int getWidth() const {
+    return m_width;
+  }
+
+  /// @return Height of the mask. It may be 0 if the region falls outside the stamp
+  int getHeight() const {
+    return m_height;
+  }
+
+  /// @return The usable pixels of the row y
+  MaskRow getUsableRow(int y) const {
+    return {m_usable.data() + (y - m_min_y) * m_row_words, m_min_x};
+  }
+
+  /// @return The pixels of the row y that belong to a neighbour
+  MaskRow getNeighbourRow(int y) const {
+    return {m_neighbour.data() + (y - m_min_y) * m_row_words, m_min_x};
+  }
+
+  /// @return true if any pixel of the region belongs to a neighbour
+  bool hasNeighbours() const {
+    return m_has_neighbours;
+  }
+
+  /**
+   * Call f(x, y) for each pixel that belongs to a neighbour, row by row. Only the words
+   * with some bit set are looked into
+   */
+  template <typename F>
+  void forEachNeighbour(F&& f) const {
+    if (!m_has_neighbours) {
+      return;
+    }
+    for (int y = 0; y < m_height; ++y) {
+      const uint64_t* row = m_neighbour.data() + y * m_row_words;
+      for (int w = 0; w < m_row_words; ++w) {
+        for (uint64_t word = row[w]; word; word &= word - 1) {
+          f(m_min_x + w * 64 + __builtin_ctzll(word), m_min_y + y);
+        }
+      }
+    }
+  }
+
+private:
+  int m_min_x = 0, m_min_y = 0, m_width = 0, m_height = 0;
+  /// Each row starts on its own word, so rows can be handed out independently
+  int m_row_words = 0;
+  bool m_has_neighbours = false;
+  std::vector<uint64_t> m_usable, m_neighbour;
+};
+
+}  // namespace Petrosian
+
+#endif
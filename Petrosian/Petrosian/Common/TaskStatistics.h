@@ -0,0 +1,124 @@
+/**
+ * @file Petrosian/Common/TaskStatistics.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_COMMON_TASKSTATISTICS_H
+#define _PETROSIAN_COMMON_TASKSTATISTICS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace Petrosian {
+
+/**
+ * @struct TaskCost
+ * @brief
+ *  What one run of a task has cost
+ */
+struct TaskCost {
+  /// Time spent waiting for the global lock, in nanoseconds
+  uint64_t m_lock_wait;
+  /// Time spent measuring, without the lock, in nanoseconds
+  uint64_t m_compute;
+  /// Pixels copied from the image
+  uint64_t m_pixels;
+  /// Rings evaluated by the radius search
+  uint64_t m_rings;
+};
+
+/**
+ * @class Stopwatch
+ * @brief
+ *  Measures the time elapsed since its construction
+ */
+class Stopwatch {
+
+public:
+
+  Stopwatch() : m_start(std::chrono::steady_clock::now()) {}
+
+  /// @return Nanoseconds since the construction
+  uint64_t elapsed() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+  }
+
+private:
+  std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+ * @class TaskStatistics
+ * @brief
+ *  Collects the cost of the Petrosian tasks over the whole run, so it can be summarized at the end.
+ * @details
+ *  Each thread records into its own block of counters and log2 histograms, so recording does not
+ *  need any lock nor atomic read-modify-write. Blocks are only created the first time a thread records,
+ *  and they outlive the thread, as SourceXtractor may stop its workers before unloading the plugin.
+ */
+class TaskStatistics {
+
+public:
+
+  /// Kind of task a cost is recorded for
+  enum Stage {
+    PROFILE,
+    RADIUS,
+    PHOTOMETRY,
+    NSTAGES
+  };
+
+  /**
+   * @struct Summary
+   * @brief
+   *  Totals and approximate percentiles of one stage, over all threads
+   */
+  struct Summary {
+    uint64_t m_count;
+    TaskCost m_total;
+    /// Upper bound of the bin where the 50th and 99th percentile of the lock wait fall, in nanoseconds
+    uint64_t m_lock_wait_p50, m_lock_wait_p99;
+    /// Same, for the compute time
+    uint64_t m_compute_p50, m_compute_p99;
+  };
+
+  /**
+   * Record the cost of one run of a task, on the block of the calling thread
+   */
+  static void record(Stage stage, const TaskCost& cost);
+
+  /**
+   * Add up the blocks of all threads. Threads may still be recording, in which case their
+   * latest runs may or may not be included
+   */
+  static Summary summarize(Stage stage);
+
+  /// @return A human readable name for the stage
+  static const char* getStageName(Stage stage);
+
+  /// @return How many threads have recorded anything
+  static size_t getThreadCount();
+};
+
+}  // namespace Petrosian
+
+#endif
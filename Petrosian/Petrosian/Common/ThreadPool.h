@@ -0,0 +1,97 @@
+/**
+ * @file Petrosian/Common/ThreadPool.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#ifndef _PETROSIAN_COMMON_THREADPOOL_H
+#define _PETROSIAN_COMMON_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Petrosian {
+
+/**
+ * @class ThreadPool
+ * @brief
+ *  Fixed set of threads that help to run loops in parallel.
+ * @details
+ *  SourceXtractor already measures different sources on different threads. This pool is meant
+ *  to split further the work of a single source, when it is big enough to be worth it (i.e. one
+ *  measurement per band, or one block of rows of a huge stamp, see RowBlocks). Several threads can
+ *  use the same pool at the same time.
+ *  The functions run on the pool must not acquire the global lock, nor access the properties
+ *  of the source.
+ */
+class ThreadPool {
+
+public:
+
+  /**
+   * Constructor
+   * @param nthreads
+   *    Number of threads to start
+   */
+  explicit ThreadPool(unsigned nthreads);
+
+  /**
+   * Destructor. Waits for the threads to finish
+   */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * Call function(i) for i in [0, n), and wait for all of them to finish.
+   * The calling thread takes part too, so this can not deadlock even if all the pool
+   * threads are busy. If any call throws, the first exception is rethrown here.
+   */
+  void parallelFor(size_t n, const std::function<void(size_t)>& function);
+
+  /// @return Number of threads in the pool
+  unsigned size() const {
+    return static_cast<unsigned>(m_threads.size());
+  }
+
+private:
+  struct Batch;
+
+  void work();
+
+  static void run(Batch& batch);
+
+  std::vector<std::thread> m_threads;
+  std::deque<std::shared_ptr<Batch>> m_queue;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  bool m_stop;
+};
+
+}  // namespace Petrosian
+
+#endif
@@ -26,6 +26,8 @@
 
 #include <Configuration/Configuration.h>
 #include <boost/filesystem/path.hpp>
+#include <vector>
+#include "Petrosian/PetrosianRadius/RadiusSearch.h"
 
 namespace Petrosian {
 
@@ -91,6 +93,78 @@ public:
    */
   double getMinRadius() const;
 
+  /**
+   * Getter for the factors of the additional apertures, empty if there are none
+   */
+  const std::vector<double>& getFactors() const;
+
+  /**
+   * Getter for the strategy used to look for the Petrosian radius
+   */
+  RadiusSearchMode getSearchMode() const;
+
+  /**
+   * Getter for the stamp area above which the radius is first looked for on a binned stamp.
+   * 0 if disabled
+   */
+  int getBinningArea() const;
+
+  /**
+   * Getter for the binning factor used by the coarse search
+   */
+  int getBinningFactor() const;
+
+  /**
+   * Getter for the isophotal SNR below which the Petrosian radius is estimated from the
+   * moments of the source, instead of its profile. 0 if disabled
+   */
+  double getTierSnr() const;
+
+  /**
+   * Getter for the number of detected pixels below which the Petrosian radius is estimated
+   * from the moments of the source. 0 if disabled
+   */
+  int getTierArea() const;
+
+  /**
+   * Getter for the extent, in units of the source ellipse, up to which the Petrosian profile
+   * is extended while the radius is not found
+   */
+  double getMaxNsigmas() const;
+
+  /**
+   * @return true if the Petrosian photometry weights the pixels on the edge of the aperture by
+   *    the fraction that is inside
+   */
+  bool useExactOverlap() const;
+
+  /**
+   * @return true if the Petrosian radius and photometry are to be computed for whole groups at once
+   */
+  bool useGroupTasks() const;
+
+  /**
+   * @return true if the PetrosianPhotometryArray is to be computed measuring all the frames in one go
+   */
+  bool useFusedPhotometry() const;
+
+  /**
+   * Getter for the number of additional threads used to measure the frames of a source in parallel.
+   * 0 if disabled
+   */
+  int getBandThreads() const;
+
+  /**
+   * Getter for the number of pixels above which a stamp is reduced by blocks of rows. 0 if disabled
+   */
+  int getBlockArea() const;
+
+  /**
+   * Getter for the number of additional threads used to reduce the blocks of rows in parallel.
+   * 0 if disabled
+   */
+  int getBlockThreads() const;
+
   /**
    * Getter for the configured check image
    */
@@ -98,6 +172,15 @@ public:
 
 private:
   double m_eta, m_factor, m_minrad;
+  std::vector<double> m_factors;
+  RadiusSearchMode m_search_mode;
+  int m_binning_area, m_binning_factor;
+  double m_tier_snr;
+  int m_tier_area;
+  double m_max_nsigmas;
+  bool m_exact_overlap, m_group_tasks, m_fused_photometry;
+  int m_band_threads;
+  int m_block_area, m_block_threads;
   boost::filesystem::path m_checkimage;
 };
 
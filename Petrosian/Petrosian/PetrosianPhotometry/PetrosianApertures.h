@@ -0,0 +1,67 @@
+/**
+ * @file Petrosian/PetrosianPhotometry/PetrosianApertures.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_PETROSIANPHOTOMETRY_PETROSIANAPERTURES_H
+#define _PETROSIAN_PETROSIANPHOTOMETRY_PETROSIANAPERTURES_H
+
+#include <SEFramework/Property/Property.h>
+#include <vector>
+#include "Petrosian/PetrosianPhotometry/PetrosianPhotometry.h"
+
+namespace Petrosian {
+
+/**
+ * @class PetrosianApertures
+ * @brief
+ *  This class holds the photometry of one source in one measurement frame, within each one
+ *  of the additional apertures given by petrosian-factors
+ * @details
+ *  It is set by the same tasks as PetrosianPhotometry, as all the apertures are measured
+ *  together with the main one
+ */
+class PetrosianApertures: public SourceXtractor::Property {
+
+public:
+
+  /**
+   * Default destructor
+   */
+  virtual ~PetrosianApertures() = default;
+
+  /**
+   * Constructor
+   * @param apertures
+   *    One photometry per factor, in the order given by the configuration
+   */
+  explicit PetrosianApertures(std::vector<PetrosianPhotometry> apertures);
+
+  const std::vector<PetrosianPhotometry>& getApertures() const;
+
+private:
+  std::vector<PetrosianPhotometry> m_apertures;
+};  // End of PetrosianApertures class
+
+}  // namespace Petrosian
+
+
+#endif
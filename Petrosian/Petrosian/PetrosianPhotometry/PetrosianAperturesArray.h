@@ -0,0 +1,84 @@
+/**
+ * @file Petrosian/PetrosianPhotometry/PetrosianAperturesArray.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_PETROSIANPHOTOMETRY_PETROSIANAPERTURESARRAY_H
+#define _PETROSIAN_PETROSIANPHOTOMETRY_PETROSIANAPERTURESARRAY_H
+
+#include <SEFramework/Property/Property.h>
+#include <NdArray/NdArray.h>
+#include <vector>
+#include "Petrosian/PetrosianPhotometry/PetrosianPhotometry.h"
+
+namespace Petrosian {
+
+/**
+ * @class PetrosianAperturesArray
+ * @brief
+ *  This class holds the photometries within the additional apertures, measured in
+ *  different frames, for a given source.
+ * @details
+ *  The getters return two dimensional arrays, with one row per frame, and one column
+ *  per aperture. They are written as two dimensional columns.
+ */
+class PetrosianAperturesArray: public SourceXtractor::Property {
+
+public:
+
+  /**
+   * Default destructor
+   */
+  virtual ~PetrosianAperturesArray() = default;
+
+  /**
+   * Constructor
+   * @param photometries
+   *    The apertures of the first frame, followed by those of the second, and so on
+   * @param napertures
+   *    Number of apertures per frame
+   */
+  PetrosianAperturesArray(std::vector<PetrosianPhotometry> photometries, std::size_t napertures);
+
+  Euclid::NdArray::NdArray<double> getFluxes() const;
+
+  Euclid::NdArray::NdArray<double> getFluxErrors() const;
+
+  Euclid::NdArray::NdArray<double> getMags() const;
+
+  Euclid::NdArray::NdArray<double> getMagErrors() const;
+
+  Euclid::NdArray::NdArray<int64_t> getFlags() const;
+
+private:
+  std::vector<PetrosianPhotometry> m_photometries;
+  std::size_t m_napertures;
+
+  /// Build a frames x apertures array with the value returned by getter for each photometry
+  template <typename T, typename Getter>
+  Euclid::NdArray::NdArray<T> toNdArray(Getter getter) const;
+
+};  // End of PetrosianAperturesArray class
+
+}  // namespace Petrosian
+
+
+#endif
@@ -25,43 +25,68 @@
 #define _PETROSIAN_PETROSIANPHOTOMETRY_PETROSIANPHOTOMETRYARRAY_H
 
 #include <SEFramework/Property/Property.h>
+#include "Petrosian/Common/SmallVector.h"
 #include "Petrosian/PetrosianPhotometry/PetrosianPhotometry.h"
 
 namespace Petrosian {
 
+/// Number of bands a PetrosianPhotometryArray can hold without allocating
+constexpr std::size_t PETRO_INLINE_BANDS = 10;
+
 /**
- * @class PetrosianPhotometryArray
+ * @class BasicPetrosianPhotometryArray
  * @brief
  *  This class holds all the photometries, measured in different frames,
  *  for a given source.
+ * @details
+ *  There is one of these per source, so the values are kept in a single block: one column
+ *  after the other, inline for up to PETRO_INLINE_BANDS bands. The getters return views
+ *  of this block, so the output columns can be built copying the values only once.
+ * @tparam T
+ *  Type used to store the values. The columns are written with this same type
  */
-class PetrosianPhotometryArray: public SourceXtractor::Property {
+template <typename T>
+class BasicPetrosianPhotometryArray: public SourceXtractor::Property {
 
 public:
 
+  using ValueType = T;
+
   /**
    * Default destructor
    */
-  virtual ~PetrosianPhotometryArray() = default;
+  virtual ~BasicPetrosianPhotometryArray() = default;
+
+  BasicPetrosianPhotometryArray(const std::vector<PetrosianPhotometry>& photometries);
 
-  PetrosianPhotometryArray(const std::vector<PetrosianPhotometry>& photometries);
+  /// @return Number of frames
+  std::size_t size() const;
 
-  std::vector<double> getFluxes() const;
+  ArrayView<T> getFluxes() const;
 
-  std::vector<double> getFluxErrors() const;
+  ArrayView<T> getFluxErrors() const;
 
-  std::vector<double> getMags() const;
+  ArrayView<T> getMags() const;
 
-  std::vector<double> getMagErrors() const;
+  ArrayView<T> getMagErrors() const;
 
-  std::vector<SourceXtractor::Flags> getFlags() const;
+  ArrayView<SourceXtractor::Flags> getFlags() const;
 
 private:
-  std::vector<double> m_fluxes, m_flux_errors;
-  std::vector<double> m_mags, m_mag_errors;
-  std::vector<SourceXtractor::Flags> m_flags;
+  enum Column { FLUX = 0, FLUX_ERROR, MAG, MAG_ERROR, NCOLUMNS };
 
-};  // End of PetrosianPhotometryArray class
+  std::size_t m_nbands;
+  SmallVector<T, NCOLUMNS * PETRO_INLINE_BANDS> m_values;
+  SmallVector<SourceXtractor::Flags, PETRO_INLINE_BANDS> m_flags;
+
+};  // End of BasicPetrosianPhotometryArray class
+
+// Built with PETROSIAN_FLOAT32, the values take half the memory, and are written as float32
+#ifdef PETROSIAN_FLOAT32
+using PetrosianPhotometryArray = BasicPetrosianPhotometryArray<float>;
+#else
+using PetrosianPhotometryArray = BasicPetrosianPhotometryArray<double>;
+#endif
 
 }  // namespace Petrosian
 
@@ -0,0 +1,106 @@
+/**
+ * @file Petrosian/PetrosianPhotometry/PetrosianPhotometryFusedTask.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#ifndef _PLUGIN_PETROSIANPHOTOMETRY_PETROSIANPHOTOMETRYFUSEDTASK_H
+#define _PLUGIN_PETROSIANPHOTOMETRY_PETROSIANPHOTOMETRYFUSEDTASK_H
+
+#include <SEFramework/Task/SourceTask.h>
+#include <boost/filesystem/path.hpp>
+#include "Petrosian/Common/ThreadPool.h"
+#include "Petrosian/PetrosianPhotometry/PhotometryMeasurement.h"
+
+namespace Petrosian {
+
+/**
+ * @class PetrosianPhotometryFusedTask
+ * @brief
+ *  Computes the PetrosianPhotometryArray of a source measuring all the frames in one go.
+ * @details
+ *  PetrosianPhotometryArrayTask requests the PetrosianPhotometry of each frame, and each one
+ *  is computed by its own task, which gets again the shape of the source and acquires the global lock.
+ *  This task does instead:
+ *  - get the Petrosian ellipse once, and project it into every frame
+ *  - copy the stamps of all frames acquiring the global lock once
+ *  - measure the frames, optionally in parallel on a ThreadPool
+ *  - set both the PetrosianPhotometry of every frame, and the PetrosianPhotometryArray
+ * @see
+ *  PetrosianPhotometryArrayTask, PetrosianPhotometryTask
+ */
+class PetrosianPhotometryFusedTask : public SourceXtractor::SourceTask {
+
+public:
+
+  /**
+   * Default destructor
+   */
+  virtual ~PetrosianPhotometryFusedTask() = default;
+
+  /**
+   * Constructor
+   * @param images
+   *    List of frame IDs to measure
+   * @param frame_sizes
+   *    Dimensions of each frame, so those that do not cover the source are skipped
+   * @param mag_zeropoint
+   *    Magnitude zeropoint
+   * @param use_symmetry
+   *    Use symmetric pixels to cover for bad/masked out pixels
+   * @param exact_overlap
+   *    Weight the pixels crossed by the edge of the aperture by the fraction that is inside
+   * @param factors
+   *    Factors of the additional apertures, measured in the same pass. Can be empty
+   * @param minrad
+   *    Minimum radius of the additional apertures
+   * @param checkimage
+   *    Optional path for a check image, so we can generate an image with the apertures being used
+   * @param pool
+   *    Threads on which to measure the frames in parallel. Can be nullptr, in which case
+   *    the frames are measured one after the other
+   * @param blocks
+   *    How the rows of big apertures are split to be integrated in parallel
+   */
+  PetrosianPhotometryFusedTask(const std::vector<unsigned>& images, const std::vector<FrameSize>& frame_sizes,
+                               double mag_zeropoint, bool use_symmetry,
+                               bool exact_overlap, const std::vector<double>& factors, double minrad,
+                               const boost::filesystem::path& checkimage, std::shared_ptr<ThreadPool> pool,
+                               const RowBlocks& blocks);
+
+  /**
+   * @brief
+   *    Compute the photometry on every frame
+   * @param source
+   *    The source for which to compute the property
+   */
+  void computeProperties(SourceXtractor::SourceInterface& source) const override;
+
+private:
+  std::vector<unsigned> m_images;
+  std::vector<PhotometryMeasurement> m_measurements;
+  std::shared_ptr<ThreadPool> m_pool;
+};  // End of PetrosianPhotometryFusedTask class
+
+}  // namespace Petrosian
+
+
+#endif
@@ -0,0 +1,78 @@
+/**
+ * @file Petrosian/PetrosianPhotometry/PetrosianPhotometryGroupTask.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#ifndef _PLUGIN_PETROSIANPHOTOMETRY_PETROSIANPHOTOMETRYGROUPTASK_H
+#define _PLUGIN_PETROSIANPHOTOMETRY_PETROSIANPHOTOMETRYGROUPTASK_H
+
+#include <SEFramework/Task/GroupTask.h>
+#include <boost/filesystem/path.hpp>
+#include "Petrosian/PetrosianPhotometry/PhotometryMeasurement.h"
+
+namespace Petrosian {
+
+/**
+ * @class PetrosianPhotometryGroupTask
+ * @brief
+ *  Measures the photometry of all the sources of a group on a given frame.
+ * @details
+ *  The measurement stamp covering the apertures of all members is copied once, and then
+ *  each one is measured as PetrosianPhotometryTask does.
+ * @see
+ *  PetrosianPhotometryTask
+ */
+class PetrosianPhotometryGroupTask : public SourceXtractor::GroupTask {
+
+public:
+
+  /**
+   * Default destructor
+   */
+  virtual ~PetrosianPhotometryGroupTask() = default;
+
+  /**
+   * Constructor
+   * @see PetrosianPhotometryTask
+   */
+  PetrosianPhotometryGroupTask(unsigned instance, const FrameSize& frame_size,
+                               double mag_zeropoint, bool use_symmetry, bool exact_overlap,
+                               const std::vector<double>& factors, double minrad,
+                               const boost::filesystem::path& checkimage, const RowBlocks& blocks);
+
+  /**
+   * @brief
+   *    Compute the PetrosianPhotometry of every source in the group for this frame
+   * @param group
+   *    The group of sources
+   */
+  void computeProperties(SourceXtractor::SourceGroupInterface& group) const override;
+
+private:
+  unsigned m_instance;
+  PhotometryMeasurement m_measurement;
+};  // End of PetrosianPhotometryGroupTask class
+
+}  // namespace Petrosian
+
+
+#endif
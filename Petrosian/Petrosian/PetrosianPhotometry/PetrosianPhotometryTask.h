@@ -26,6 +26,7 @@
 
 #include <SEFramework/Task/SourceTask.h>
 #include <boost/filesystem/path.hpp>
+#include "Petrosian/PetrosianPhotometry/PhotometryMeasurement.h"
 
 namespace Petrosian {
 
@@ -38,7 +39,7 @@ namespace Petrosian {
  *  For measurements that work on source groups - like the Model Fitting does -,
  *  it would have to inherit from SourceXtractor::GroupTask
  * @see
- *  SourceXtractor::GroupTask
+ *  SourceXtractor::GroupTask, PetrosianPhotometryGroupTask
  */
 class PetrosianPhotometryTask : public SourceXtractor::SourceTask {
 
@@ -54,15 +55,26 @@ public:
    * @param m_instance
    *    Since there is one property per source per image, this parameter identifies
    *    the frame on which this task is working
+   * @param frame_size
+   *    Dimensions of the frame, so sources that fall off it are not measured
    * @param mag_zeropoint
    *    Magnitude zeropoint
    * @param use_symmetry
    *    Use symmetric pixels to cover for bad/masked out pixels
+   * @param exact_overlap
+   *    Weight the pixels crossed by the edge of the aperture by the fraction that is inside
+   * @param factors
+   *    Factors of the additional apertures, measured in the same pass. Can be empty
+   * @param minrad
+   *    Minimum radius of the additional apertures
    * @param checkimage
    *    Optional path for a check image, so we can generate an image with the apertures being used
+   * @param blocks
+   *    How the rows of big apertures are split to be integrated in parallel
    */
-  PetrosianPhotometryTask(unsigned m_instance, double mag_zeropoint, bool use_symmetry,
-                          const boost::filesystem::path& checkimage);
+  PetrosianPhotometryTask(unsigned m_instance, const FrameSize& frame_size, double mag_zeropoint, bool use_symmetry,
+                          bool exact_overlap, const std::vector<double>& factors, double minrad,
+                          const boost::filesystem::path& checkimage, const RowBlocks& blocks);
 
   /**
    * @brief
@@ -76,9 +88,7 @@ public:
 
 private:
   unsigned m_instance;
-  double m_mag_zeropoint;
-  bool m_use_symmetry;
-  boost::filesystem::path m_checkimage;
+  PhotometryMeasurement m_measurement;
 };  // End of PetrosianPhotometryTask class
 
 }  // namespace Petrosian
@@ -25,6 +25,8 @@
 #define _PLUGIN_PETROSIANPHOTOMETRY_PETROSIANPHOTOMETRYTASKFACTORY_H
 
 #include <SEFramework/Task/TaskFactory.h>
+#include "Petrosian/Common/ThreadPool.h"
+#include "Petrosian/PetrosianPhotometry/PhotometryMeasurement.h"
 
 namespace Petrosian {
 
@@ -72,10 +74,25 @@ public:
 
 private:
   double m_magnitude_zero_point;
-  bool m_use_symmetry;
+  bool m_use_symmetry, m_exact_overlap, m_group_tasks, m_fused_photometry;
   boost::filesystem::path m_checkimage;
 
+  /// Main Petrosian factor, minimum radius, and factors of the additional apertures, which may be empty
+  double m_factor, m_minrad;
+  std::vector<double> m_factors;
+
+  /// Shared by all the fused tasks, nullptr if the frames are measured sequentially
+  std::shared_ptr<ThreadPool> m_band_pool;
+
+  /// Shared by all the photometry tasks
+  RowBlocks m_blocks;
+
   std::vector<unsigned> m_images;
+  /// Dimensions of each one of m_images
+  std::vector<FrameSize> m_frame_sizes;
+
+  /// @return The dimensions of the given frame
+  FrameSize getFrameSize(unsigned image) const;
 
 };  // End of PetrosianPhotometryTaskFactory class
 
@@ -0,0 +1,221 @@
+/**
+ * @file Petrosian/PetrosianPhotometry/PhotometryMeasurement.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#ifndef _PLUGIN_PETROSIANPHOTOMETRY_PHOTOMETRYMEASUREMENT_H
+#define _PLUGIN_PETROSIANPHOTOMETRY_PHOTOMETRYMEASUREMENT_H
+
+#include <SEFramework/Source/SourceInterface.h>
+#include <SEUtils/PixelCoordinate.h>
+#include <SEUtils/Types.h>
+#include <boost/filesystem/path.hpp>
+#include <string>
+#include <vector>
+#include "Petrosian/Common/CheckImageSink.h"
+#include "Petrosian/Common/EllipseAperture.h"
+#include "Petrosian/Common/ImageStamp.h"
+#include "Petrosian/Common/RowBlocks.h"
+#include "Petrosian/PetrosianPhotometry/PetrosianPhotometry.h"
+
+namespace Petrosian {
+
+/**
+ * @struct FrameSize
+ * @brief
+ *  Dimensions of a measurement frame. They are known from the configuration, so sources that fall
+ *  off the frame can be found without accessing it
+ */
+struct FrameSize {
+  /// 0 if unknown, in which case every source is measured
+  int m_width, m_height;
+};
+
+/**
+ * @struct PhotometryShape
+ * @brief
+ *  Petrosian ellipse of a source on the detection frame. It is the same for all measurement frames
+ */
+struct PhotometryShape {
+  SourceXtractor::SeFloat m_cxx, m_cyy, m_cxy, m_radius;
+  /// Petrosian radius before scaling, from which the additional apertures are scaled
+  SourceXtractor::SeFloat m_petrosian_radius;
+  /// Radius of the closest pixel of a neighbour, or infinity if there is none
+  SourceXtractor::SeFloat m_neighbour_radius;
+};
+
+/**
+ * @struct PhotometryAperture
+ * @brief
+ *  Petrosian aperture of a source, projected on a measurement frame.
+ * @details
+ *  Only the parameters are kept, and the aperture is built on the stack when
+ *  needed, so no allocation is done per source
+ */
+struct PhotometryAperture {
+  /// Ellipse on the measurement frame (the Jacobian is already applied), scaled by the Petrosian radius
+  double m_cxx, m_cyy, m_cxy, m_radius;
+  /// Petrosian radius before scaling, from which the additional apertures are scaled
+  double m_petrosian_radius;
+  /// Apertures with a radius above this reach a neighbour, and are flagged
+  double m_neighbour_radius;
+  /// Center of the aperture on the measurement frame
+  SourceXtractor::SeFloat m_centroid_x, m_centroid_y;
+  /// Corners of the stamp required to measure the aperture, and the additional ones (included)
+  SourceXtractor::PixelCoordinate m_min_pixel, m_max_pixel;
+
+  EllipseAperture getEllipse() const {
+    return {m_cxx, m_cyy, m_cxy, m_radius, m_centroid_x, m_centroid_y};
+  }
+};
+
+/**
+ * @class PhotometryMeasurement
+ * @brief
+ *  Measures the Petrosian photometry of a source from a stamp of a measurement frame.
+ * @details
+ *  It does not access the frame itself, so the same stamp can be shared by several sources
+ *  (i.e. those of a group), and the same code is used by PetrosianPhotometryTask and
+ *  PetrosianPhotometryGroupTask
+ */
+class PhotometryMeasurement {
+
+public:
+
+  /**
+   * Constructor
+   * @see PetrosianPhotometryTask
+   */
+  PhotometryMeasurement(unsigned instance, const FrameSize& frame_size, double mag_zeropoint,
+                        bool use_symmetry, bool exact_overlap, const std::vector<double>& factors, double minrad,
+                        const boost::filesystem::path& checkimage, const RowBlocks& blocks);
+
+  /**
+   * Get the Petrosian ellipse of the source, which does not depend on the measurement frame
+   */
+  static PhotometryShape getShape(SourceXtractor::SourceInterface& source);
+
+  /**
+   * Build the aperture of the source on the measurement frame
+   */
+  PhotometryAperture getAperture(SourceXtractor::SourceInterface& source) const;
+
+  /**
+   * Build the aperture of the source on the measurement frame, from an already known shape
+   */
+  PhotometryAperture getAperture(SourceXtractor::SourceInterface& source, const PhotometryShape& shape) const;
+
+  /**
+   * @return true if the stamp required by the aperture falls entirely off the frame, so the source
+   *    does not need to be measured, nor the frame accessed
+   */
+  bool isOutside(const PhotometryAperture& aperture) const {
+    return m_frame_size.m_width > 0 &&
+           (aperture.m_max_pixel.m_x < 0 || aperture.m_max_pixel.m_y < 0 ||
+            aperture.m_min_pixel.m_x >= m_frame_size.m_width || aperture.m_min_pixel.m_y >= m_frame_size.m_height);
+  }
+
+  /**
+   * Photometry of a source that falls off the frame: NaN values, flagged as OUTSIDE
+   * @param apertures
+   *    If there are additional apertures, set to one such photometry per factor
+   */
+  PetrosianPhotometry computeOutside(std::vector<PetrosianPhotometry>& apertures) const;
+
+  /**
+   * Set the properties of a source that falls off the frame, as computeOutside does
+   */
+  void measureOutside(SourceXtractor::SourceInterface& source) const;
+
+  /**
+   * Measure the flux within the aperture. It does not touch the source nor the frame, so it can
+   * run on any thread.
+   * @see measure
+   */
+  PetrosianPhotometry compute(const PhotometryAperture& aperture, const ImageStamp& stamp,
+                              SourceXtractor::SeFloat variance_threshold, double gain) const;
+
+  /// @return true if there are additional apertures to measure, and set as PetrosianApertures
+  bool hasApertures() const {
+    return !m_factors.empty();
+  }
+
+  /**
+   * Measure the flux within the aperture and within the additional ones, with a single pass
+   * over the pixels. Like the above, it can run on any thread.
+   * @param apertures
+   *    Set to one photometry per factor, in the configured order
+   * @return
+   *    The photometry within the main aperture, as compute would return
+   */
+  PetrosianPhotometry compute(const PhotometryAperture& aperture, const ImageStamp& stamp,
+                              SourceXtractor::SeFloat variance_threshold, double gain,
+                              std::vector<PetrosianPhotometry>& apertures) const;
+
+  /**
+   * If configured, draw the aperture on the check image
+   * @param source
+   *    The source, used for its identifier
+   * @param aperture
+   *    Its aperture
+   * @param stamp
+   *    Measurement stamp, used for the size of the image
+   */
+  void fillCheckImage(SourceXtractor::SourceInterface& source, const PhotometryAperture& aperture,
+                      const ImageStamp& stamp) const;
+
+  /**
+   * Measure the flux within the aperture, and set the PetrosianPhotometry property of the source.
+   * If there are additional apertures, they are measured too, and set as PetrosianApertures.
+   * If configured, the aperture is also drawn on the check image.
+   * @param source
+   *    The source
+   * @param aperture
+   *    Its aperture, as returned by getAperture
+   * @param stamp
+   *    Measurement stamp. It must contain the region given by the aperture
+   * @param variance_threshold
+   *    Pixels with a variance above this are considered bad
+   * @param gain
+   *    Gain of the measurement frame
+   */
+  void measure(SourceXtractor::SourceInterface& source, const PhotometryAperture& aperture,
+               const ImageStamp& stamp, SourceXtractor::SeFloat variance_threshold, double gain) const;
+
+private:
+  unsigned m_instance;
+  FrameSize m_frame_size;
+  double m_mag_zeropoint;
+  bool m_use_symmetry, m_exact_overlap;
+  /// Factors of the additional apertures, and the minimum radius they are scaled to
+  std::vector<double> m_factors;
+  double m_minrad;
+  boost::filesystem::path m_checkimage;
+  /// How the rows of big apertures are split to be integrated in parallel
+  RowBlocks m_blocks;
+  /// Writer for the check image of this frame, nullptr if there is none
+  std::shared_ptr<CheckImageSink> m_checkimage_sink;
+};
+
+}  // namespace Petrosian
+
+#endif
@@ -43,9 +43,9 @@ class PetrosianPlugin : public SourceXtractor::Plugin {
 public:
 
   /**
-   * Default destructor
+   * Destructor. Reports how often the plugin tasks had to wait for the global lock
    */
-  virtual ~PetrosianPlugin() = default;
+  virtual ~PetrosianPlugin();
 
   /**
    * @return
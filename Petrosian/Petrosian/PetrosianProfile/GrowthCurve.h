@@ -0,0 +1,93 @@
+/**
+ * @file Petrosian/PetrosianProfile/GrowthCurve.h
+ * @date 17/10/26
+ * @author agent
+ *
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_PETROSIANPROFILE_GROWTHCURVE_H
+#define _PETROSIAN_PETROSIANPROFILE_GROWTHCURVE_H
+
+#include "Petrosian/Common/CumulativeProfile.h"
+
+namespace Petrosian {
+
+/**
+ * @class GrowthCurve
+ * @brief
+ *  The flux enclosed by any elliptical radius of a source, read from the profiles built by
+ *  ProfileMeasurement.
+ * @details
+ *  Radii are in units of the source ellipse. The full resolution profile is exact between an inner
+ *  radius - 0 unless the source has been binned - and its outer radius. For binned sources,
+ *  all the pixels within the inner radius are added at the center, and a coarse profile
+ *  of the whole source is used outside the full resolution range.
+ *
+ *  It does not own the profiles: they are working memory of the thread that built them, and
+ *  the curve is only valid until that thread profiles another source.
+ */
+class GrowthCurve {
+
+public:
+
+  /**
+   * Constructor
+   * @param profile
+   *    Full resolution profile
+   * @param inner
+   *    Radius below which the full resolution profile is not exact
+   * @param coarse
+   *    Coarse profile, used outside the full resolution range, or nullptr if the source has not been binned
+   */
+  GrowthCurve(const CumulativeProfile& profile, double inner, const CumulativeProfile* coarse);
+
+  /// @return The full resolution profile
+  const CumulativeProfile& getProfile() const;
+
+  /// @return The radius below which the full resolution profile is not exact
+  double getInnerRadius() const;
+
+  /// @return The outermost radius covered by the curve, at full resolution or not
+  double getMaxRadius() const;
+
+  /**
+   * @return The flux enclosed by the given radius, from the full resolution profile where possible
+   */
+  double getFlux(double radius) const;
+
+  /**
+   * Inverse of getFlux: find where the curve reaches a given flux
+   * @return The smallest radius up to max_radius that encloses the flux, or max_radius if none does
+   */
+  double getRadius(double flux, double max_radius) const;
+
+private:
+  const CumulativeProfile& m_profile;
+  double m_inner;
+  const CumulativeProfile* m_coarse;
+
+  bool isFine(double radius) const;
+
+};  // End of GrowthCurve class
+
+}  // namespace Petrosian
+
+
+#endif
@@ -0,0 +1,77 @@
+/**
+ * @file Petrosian/PetrosianProfile/PetrosianProfileGroupTask.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#ifndef _PETROSIAN_PETROSIANPROFILE_PETROSIANPROFILEGROUPTASK_H
+#define _PETROSIAN_PETROSIANPROFILE_PETROSIANPROFILEGROUPTASK_H
+
+#include <SEFramework/Task/GroupTask.h>
+#include "Petrosian/PetrosianProfile/ProfileMeasurement.h"
+
+namespace Petrosian {
+
+/**
+ * @class PetrosianProfileGroupTask
+ *  Builds the profile of all the sources of a group at once.
+ * @details
+ *  It inherits from SourceXtractor::GroupTask, so it receives the whole group instead of
+ *  a single source. The detection stamp covering all members is copied once, and then
+ *  the profile of each one is built as PetrosianProfileTask does.
+ *  Sources are grouped when they are blended, so their stamps overlap: in crowded fields this
+ *  avoids reading the same pixels several times, and acquiring the global lock once per member.
+ * @see
+ *  PetrosianProfileTask
+ */
+class PetrosianProfileGroupTask : public SourceXtractor::GroupTask {
+
+public:
+
+  /**
+   * Default destructor
+   */
+  virtual ~PetrosianProfileGroupTask() = default;
+
+  /**
+   * Constructor
+   * @see ProfileMeasurement
+   */
+  PetrosianProfileGroupTask(double eta, double factor, double minrad, RadiusSearchMode search_mode,
+                            int binning_area, int binning_factor, double tier_snr, int tier_area,
+                            double max_nsigmas, const RowBlocks& blocks);
+
+  /**
+   * @brief
+   *    Compute the PetrosianProfileRadii of every source in the group
+   * @param group
+   *    The group of sources
+   */
+  void computeProperties(SourceXtractor::SourceGroupInterface& group) const override;
+
+private:
+  ProfileMeasurement m_measurement;
+};  // End of PetrosianProfileGroupTask class
+
+}  // namespace Petrosian
+
+
+#endif
@@ -0,0 +1,104 @@
+/**
+ * @file Petrosian/PetrosianProfile/PetrosianProfileRadii.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_PETROSIANPROFILE_PETROSIANPROFILERADII_H
+#define _PETROSIAN_PETROSIANPROFILE_PETROSIANPROFILERADII_H
+
+#include <SEFramework/Property/Property.h>
+#include "Petrosian/Common/TaskStatistics.h"
+#include "Petrosian/PetrosianRadius/RadiusMeasurement.h"
+
+namespace Petrosian {
+
+/**
+ * @struct SourceEllipse
+ * @brief
+ *  Shape and position of a source on the detection frame
+ */
+struct SourceEllipse {
+  float m_cxx, m_cyy, m_cxy;
+  float m_centroid_x, m_centroid_y;
+};
+
+/**
+ * @class PetrosianProfileRadii
+ * @brief
+ *  This property holds the radii read from the growth curve of a source on the detection frame,
+ *  and the radius of its closest neighbour. It does not hold the growth curve itself.
+ * @details
+ *  The growth curve is built once from the pixels, by PetrosianProfileTask, which reads the
+ *  Petrosian and light radii from it right away. The curve itself lives in the working memory
+ *  of that thread, and is reused for the next source, so only the radii are kept here for
+ *  PetrosianRadius and PetrosianLightRadii, and the radius of the closest neighbour for PetrosianPhotometry.
+ *  The photometry is measured on the pixels, the detection frame included.
+ *
+ *  Faint or small sources may not be profiled at all (see ProfileMeasurement). Their radii are
+ *  estimated from the moments of the source instead.
+ */
+class PetrosianProfileRadii : public SourceXtractor::Property {
+
+public:
+
+  virtual ~PetrosianProfileRadii() = default;
+
+  /**
+   * Constructor
+   * @param radius
+   *    Radii measured from the growth curve, or estimated if the source has not been profiled
+   * @param neighbour_radius
+   *    Radius of the closest pixel that belongs to a neighbour, or infinity if there is none
+   */
+  PetrosianProfileRadii(const RadiusResult& radius, double neighbour_radius);
+
+  /// @return The radii measured from the growth curve
+  const RadiusResult& getRadius() const;
+
+  /**
+   * @return The radius of the closest pixel that belongs to a neighbour, or infinity if there is none.
+   *    Those pixels are masked as bad, and apertures beyond this radius are contaminated
+   */
+  double getNeighbourRadius() const;
+
+  /// @return What building the growth curve has cost
+  const TaskCost& getCost() const;
+
+  /// @return What reading the radii from the growth curve has cost
+  const TaskCost& getRadiusCost() const;
+
+  /**
+   * Set what building the growth curve, and reading the radii from it, have cost. They are only known
+   * once done, so they are set by the task before the profile becomes a property of the source
+   */
+  void setCost(const TaskCost& cost, const TaskCost& radius_cost);
+
+private:
+  RadiusResult m_radius;
+  double m_neighbour_radius;
+  TaskCost m_cost, m_radius_cost;
+
+};  // End of PetrosianProfileRadii class
+
+}  // namespace Petrosian
+
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * @file Petrosian/PetrosianProfile/PetrosianProfileTask.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_PETROSIANPROFILE_PETROSIANPROFILETASK_H
+#define _PETROSIAN_PETROSIANPROFILE_PETROSIANPROFILETASK_H
+
+#include <SEFramework/Task/SourceTask.h>
+#include "Petrosian/PetrosianProfile/ProfileMeasurement.h"
+
+namespace Petrosian {
+
+/**
+ * @class PetrosianProfileTask
+ *  This is the class responsible for building the profile of a source on the detection frame.
+ * @details
+ *  It is the only one that reads the detection pixels: the Petrosian radius and the light radii
+ *  are read from the profile as soon as it is built, and set as the PetrosianProfileRadii property.
+ * @see
+ *  PetrosianProfileGroupTask
+ */
+class PetrosianProfileTask : public SourceXtractor::SourceTask {
+
+public:
+
+  /**
+   * Default destructor
+   */
+  virtual ~PetrosianProfileTask() = default;
+
+  /**
+   * Constructor
+   * @see ProfileMeasurement
+   */
+  PetrosianProfileTask(double eta, double factor, double minrad, RadiusSearchMode search_mode, int binning_area,
+                       int binning_factor, double tier_snr, int tier_area, double max_nsigmas,
+                       const RowBlocks& blocks);
+
+  /**
+   * @brief
+   *    Compute the PetrosianProfileRadii of the source
+   * @param source
+   *    The source for which to compute the property
+   */
+  void computeProperties(SourceXtractor::SourceInterface& source) const override;
+
+private:
+  ProfileMeasurement m_measurement;
+};  // End of PetrosianProfileTask class
+
+}  // namespace Petrosian
+
+
+#endif
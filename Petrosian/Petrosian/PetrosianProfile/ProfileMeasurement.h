@@ -0,0 +1,176 @@
+/**
+ * @file Petrosian/PetrosianProfile/ProfileMeasurement.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_PETROSIANPROFILE_PROFILEMEASUREMENT_H
+#define _PETROSIAN_PETROSIANPROFILE_PROFILEMEASUREMENT_H
+
+#include <SEFramework/Source/SourceInterface.h>
+#include <functional>
+#include <vector>
+#include "Petrosian/Common/EllipseSpans.h"
+#include "Petrosian/Common/ImageStamp.h"
+#include "Petrosian/Common/RowBlocks.h"
+#include "Petrosian/PetrosianProfile/GrowthCurve.h"
+#include "Petrosian/PetrosianProfile/PetrosianProfileRadii.h"
+#include "Petrosian/PetrosianRadius/RadiusMeasurement.h"
+#include "Petrosian/PetrosianRadius/RadiusSearch.h"
+
+namespace Petrosian {
+
+/**
+ * @class ProfileMeasurement
+ * @brief
+ *  Builds the growth curve of a source from a stamp of the detection frame, and reads from it
+ *  the radii kept by its PetrosianProfileRadii.
+ * @details
+ *  It does not access the frame itself, so the same stamp can be shared by several sources
+ *  (i.e. those of a group), and the same code is used by PetrosianProfileTask and
+ *  PetrosianProfileGroupTask.
+ *  Sources under the configured isophotal SNR or detected area are not profiled: they are
+ *  too faint or small for the profile to be worth its cost, and their radius is estimated
+ *  from their moments (see RadiusMeasurement).
+ *  The growth curve is built on working memory owned by the calling thread, which grows to fit the
+ *  biggest source seen, and is reused for the next one.
+ *  Sources whose radius is not within the stamp have their profile extended outwards, over a
+ *  bigger stamp, up to the configured extent.
+ */
+class ProfileMeasurement {
+
+public:
+
+  /**
+   * Copy into the stamp the region between min_pixel and max_pixel (included) of the detection frame.
+   * It returns the time, in nanoseconds, waited for the global lock
+   */
+  using StampCopier = std::function<uint64_t(ImageStamp&, const SourceXtractor::PixelCoordinate&,
+                                             const SourceXtractor::PixelCoordinate&)>;
+
+  /**
+   * Constructor
+   * @param eta
+   *    η
+   * @param factor
+   *    \f$N_{\rm P}\f$, used to find the light radii within the Petrosian aperture
+   * @param minrad
+   *    Minimum radius of the Petrosian aperture
+   * @param search_mode
+   *    Strategy used to look for the radius
+   * @param binning_area
+   *    Stamps with more pixels than this are first searched on a binned version, and then only
+   *    the pixels around the coarse radius are profiled at full resolution. 0 disables it
+   * @param binning_factor
+   *    Size, in pixels, of the side of the blocks used for the coarse search
+   * @param tier_snr
+   *    Sources with an isophotal SNR below this are not profiled. 0 disables it
+   * @param tier_area
+   *    Sources with fewer detected pixels than this are not profiled. 0 disables it
+   * @param max_nsigmas
+   *    Extent, in units of the source ellipse, up to which the profile of a source can be extended
+   *    while its radius is not found. If it is not greater than the default extent, there is no extension
+   * @param blocks
+   *    How the rows of big stamps are split to be profiled in parallel
+   */
+  ProfileMeasurement(double eta, double factor, double minrad, RadiusSearchMode search_mode, int binning_area,
+                     int binning_factor, double tier_snr, int tier_area, double max_nsigmas,
+                     const RowBlocks& blocks);
+
+  /**
+   * Get the centroid and shape of the source from its properties
+   */
+  static SourceEllipse getSourceEllipse(SourceXtractor::SourceInterface& source);
+
+  /**
+   * @return The pixels the profile is built from. Its bounding box is the stamp
+   *    that needs to be copied from the detection image
+   */
+  static EllipseSpans getSpans(const SourceEllipse& ellipse);
+
+  /**
+   * @return The pixels within the given radius, in units of the source ellipse
+   */
+  static EllipseSpans getSpans(const SourceEllipse& ellipse, double radius);
+
+  /**
+   * @return true if the source is below the configured SNR or area, so it must not be profiled.
+   *    The properties it depends on are only asked for if the threshold is enabled
+   */
+  bool isFaint(SourceXtractor::SourceInterface& source) const;
+
+  /**
+   * Build the growth curve of a source, and read the radii from it
+   * @param stamp
+   *    Detection stamp. It must contain the bounding box of getSpans() or, if the source is
+   *    close to the border, its intersection with the image
+   * @param ellipse
+   *    Source shape and position
+   * @param variance_threshold
+   *    Pixels with a variance not below this are bad, and their value is ignored
+   * @param source_pixels
+   *    Pixels detected as part of the source. If given, and the stamp has a thresholded image,
+   *    the pixels of neighbours are masked as bad ones (see StampMask)
+   * @param copy_stamp
+   *    Used to copy a bigger stamp when the profile is extended. If empty, it never is
+   */
+  PetrosianProfileRadii compute(const ImageStamp& stamp, const SourceEllipse& ellipse, float variance_threshold,
+                           const std::vector<SourceXtractor::PixelCoordinate>* source_pixels = nullptr,
+                           const StampCopier& copy_stamp = StampCopier()) const;
+
+  /**
+   * Build the growth curve of a source, and set what is read from it as its PetrosianProfileRadii property.
+   * If the stamp has a thresholded image, neighbours are masked.
+   * What building it costs is recorded on TaskStatistics, and kept by the profile
+   * @param lock_wait
+   *    Time, in nanoseconds, the task waited for the global lock to copy the stamp of this source.
+   *    The waits of copy_stamp are added to it
+   * @see compute
+   */
+  void measure(SourceXtractor::SourceInterface& source, const ImageStamp& stamp, const SourceEllipse& ellipse,
+               float variance_threshold, uint64_t lock_wait, const StampCopier& copy_stamp) const;
+
+  /**
+   * Set, for a faint source, a PetrosianProfileRadii with the estimated radii. There is no stamp to copy for it
+   */
+  void measureFaint(SourceXtractor::SourceInterface& source) const;
+
+private:
+  double m_eta;
+  RadiusSearchMode m_search_mode;
+  int m_binning_area, m_binning_factor;
+  double m_tier_snr;
+  int m_tier_area;
+  double m_max_nsigmas;
+  RowBlocks m_blocks;
+  RadiusMeasurement m_radius;
+
+  /**
+   * Read the radii from the growth curve, timing it apart
+   * @param min_pixel, max_pixel
+   *    Region of the detection frame that has been profiled
+   */
+  PetrosianProfileRadii measureRadius(const GrowthCurve& curve, const SourceXtractor::PixelCoordinate& min_pixel,
+                                 const SourceXtractor::PixelCoordinate& max_pixel, double neighbour_radius) const;
+};
+
+}  // namespace Petrosian
+
+#endif
@@ -0,0 +1,69 @@
+/**
+ * @file Petrosian/PetrosianRadius/PetrosianDiagnostics.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_PETROSIANRADIUS_PETROSIANDIAGNOSTICS_H
+#define _PETROSIAN_PETROSIANRADIUS_PETROSIANDIAGNOSTICS_H
+
+#include <SEFramework/Property/Property.h>
+#include "Petrosian/Common/TaskStatistics.h"
+
+namespace Petrosian {
+
+/**
+ * @class PetrosianDiagnostics
+ * @brief
+ *  This property holds what the Petrosian radius of a source has cost: building its profile,
+ *  and looking for the radius on it.
+ * @details
+ *  It is set by the same task as PetrosianRadius, so it costs nothing to have it, but it is only
+ *  written to the catalog if asked for. The totals over the whole run are logged at the end.
+ */
+class PetrosianDiagnostics : public SourceXtractor::Property {
+
+public:
+
+  virtual ~PetrosianDiagnostics() = default;
+
+  PetrosianDiagnostics(const TaskCost& profile_cost, const TaskCost& radius_cost);
+
+  /// @return Time, in seconds, spent waiting for the global lock
+  double getLockWait() const;
+
+  /// @return Time, in seconds, spent building the profile and looking for the radius
+  double getComputeTime() const;
+
+  /// @return Pixels visited to build the profile
+  int64_t getPixels() const;
+
+  /// @return Rings evaluated to find the radius
+  int64_t getRings() const;
+
+private:
+  TaskCost m_profile_cost, m_radius_cost;
+
+};  // End of PetrosianDiagnostics class
+
+}  // namespace Petrosian
+
+
+#endif
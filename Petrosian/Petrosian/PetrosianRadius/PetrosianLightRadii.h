@@ -0,0 +1,64 @@
+/**
+ * @file Petrosian/PetrosianRadius/PetrosianLightRadii.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_PETROSIANRADIUS_PETROSIANLIGHTRADII_H
+#define _PETROSIAN_PETROSIANRADIUS_PETROSIANLIGHTRADII_H
+
+#include <SEFramework/Property/Property.h>
+
+namespace Petrosian {
+
+/**
+ * @class PetrosianLightRadii
+ * @brief
+ *  This property holds the radii that enclose 50% and 90% of the flux within the
+ *  Petrosian aperture, on the detection frame.
+ * @details
+ *  They are measured by the same task as PetrosianRadius, from the same cumulative profile,
+ *  so they do not need another pass over the pixels.
+ *  As PetrosianRadius, they are in units of the source ellipse.
+ */
+class PetrosianLightRadii : public SourceXtractor::Property {
+
+public:
+
+  virtual ~PetrosianLightRadii() = default;
+
+  PetrosianLightRadii(double r50, double r90);
+
+  double getR50() const;
+
+  double getR90() const;
+
+  /// @return The concentration index, R90 / R50
+  double getConcentration() const;
+
+private:
+  double m_r50, m_r90;
+
+};  // End of PetrosianLightRadii class
+
+}  // namespace Petrosian
+
+
+#endif
@@ -25,6 +25,7 @@
 #define _PETROSIAN_PETROSIANRADIUS_PETROSIANRADIUS_H
 
 #include <SEFramework/Property/Property.h>
+#include "Petrosian/PetrosianRadius/RadiusFlags.h"
 
 namespace Petrosian {
 
@@ -40,12 +41,27 @@ public:
 
   virtual ~PetrosianRadius() = default;
 
-  PetrosianRadius(double radius);
+  /**
+   * Constructor
+   * @param radius
+   *    Radius of the photometry aperture: the Petrosian radius scaled by the Petrosian factor,
+   *    but not smaller than the minimum radius
+   * @param petrosian_radius
+   *    The Petrosian radius itself, before scaling
+   * @param flags
+   *    How the radius was obtained
+   */
+  PetrosianRadius(double radius, double petrosian_radius, RadiusFlags flags);
 
   double getRadius() const;
 
+  double getPetrosianRadius() const;
+
+  RadiusFlags getFlags() const;
+
 private:
-  double m_radius;
+  double m_radius, m_petrosian_radius;
+  RadiusFlags m_flags;
 
 };  // End of PetrosianRadius class
 
@@ -25,6 +25,7 @@
 #define _PETROSIAN_PETROSIANRADIUS_PETROSIANRADIUSTASK_H
 
 #include <SEFramework/Task/SourceTask.h>
+#include "Petrosian/PetrosianRadius/RadiusMeasurement.h"
 
 namespace Petrosian {
 
@@ -34,9 +35,11 @@ namespace Petrosian {
  * @details
  *  It inherits from SourceXtractor::SourceTask because it is a per-source property.
  *  For measurements that work on source groups - like the Model Fitting does -,
- *  it would have to inherit from SourceXtractor::GroupTask
+ *  it would have to inherit from SourceXtractor::GroupTask.
+ *  It does not read any pixel: the radius has been read from the growth curve of the source
+ *  while building its PetrosianProfileRadii, which is another property
  * @see
- *  SourceXtractor::GroupTask
+ *  SourceXtractor::GroupTask, PetrosianProfileTask
  *
  * @see
  *  https://sextractor.readthedocs.io/en/latest/Photom.html#petrosian-aperture-flux-flux-petro
@@ -59,8 +62,10 @@ public:
    *    \f$N_{\rm P}\f$
    * @param minrad
    *    Minimum radius
+   * @param search_mode
+   *    Strategy used to look for the radius
    */
-  PetrosianRadiusTask(double eta, double factor, double minrad);
+  PetrosianRadiusTask(double eta, double factor, double minrad, RadiusSearchMode search_mode);
 
   /**
    * @brief
@@ -73,7 +78,7 @@ public:
   void computeProperties(SourceXtractor::SourceInterface& source) const override;
 
 private:
-  double m_eta, m_factor, m_minrad;
+  RadiusMeasurement m_measurement;
 };  // End of PetrosianRadiusTask class
 
 }  // namespace Petrosian
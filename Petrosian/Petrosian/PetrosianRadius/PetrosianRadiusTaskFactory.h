@@ -25,6 +25,8 @@
 #define _PETROSIAN_PETROSIANRADIUS_PETROSIANRADIUSTASKFACTORY_H
 
 #include <SEFramework/Task/TaskFactory.h>
+#include "Petrosian/Common/RowBlocks.h"
+#include "Petrosian/PetrosianRadius/RadiusSearch.h"
 
 namespace Petrosian {
 
@@ -71,6 +73,14 @@ public:
 
 private:
   double m_eta, m_factor, m_minrad;
+  RadiusSearchMode m_search_mode;
+  int m_binning_area, m_binning_factor;
+  double m_tier_snr;
+  int m_tier_area;
+  double m_max_nsigmas;
+  bool m_group_tasks;
+  /// Shared by all the profile tasks
+  RowBlocks m_blocks;
 
 };  // End of PetrosianRadiusTaskFactory class
 
@@ -0,0 +1,60 @@
+/**
+ * @file Petrosian/PetrosianRadius/RadiusFlags.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#ifndef _PETROSIAN_PETROSIANRADIUS_RADIUSFLAGS_H
+#define _PETROSIAN_PETROSIANRADIUS_RADIUSFLAGS_H
+
+#include <cstdint>
+
+namespace Petrosian {
+
+/**
+ * Flags of the Petrosian radius and light radii. They describe how the radii were obtained, which
+ * the flags of SourceXtractor, meant for the pixels of a measurement, can not tell
+ */
+enum class RadiusFlags : int64_t {
+  NONE = 0,
+  /// The radius was not found within the profile, even once extended up to its maximum, so it is only a lower bound
+  NOT_FOUND = 1ll << 0,
+  /// The source was too faint to be profiled, and the radii are those of a Gaussian with the same moments
+  ESTIMATED = 1ll << 1,
+  /// The Petrosian aperture goes beyond the profile, so the light radii only enclose the flux within the profile
+  TRUNCATED = 1ll << 2,
+};
+
+inline RadiusFlags operator|(RadiusFlags a, RadiusFlags b) {
+  return static_cast<RadiusFlags>(static_cast<int64_t>(a) | static_cast<int64_t>(b));
+}
+
+inline RadiusFlags& operator|=(RadiusFlags& a, RadiusFlags b) {
+  return a = a | b;
+}
+
+inline RadiusFlags operator&(RadiusFlags a, RadiusFlags b) {
+  return static_cast<RadiusFlags>(static_cast<int64_t>(a) & static_cast<int64_t>(b));
+}
+
+}  // namespace Petrosian
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * @file Petrosian/PetrosianRadius/RadiusMeasurement.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#ifndef _PETROSIAN_PETROSIANRADIUS_RADIUSMEASUREMENT_H
+#define _PETROSIAN_PETROSIANRADIUS_RADIUSMEASUREMENT_H
+
+#include <SEFramework/Source/SourceInterface.h>
+#include "Petrosian/PetrosianProfile/GrowthCurve.h"
+#include "Petrosian/PetrosianRadius/RadiusFlags.h"
+#include "Petrosian/PetrosianRadius/RadiusSearch.h"
+
+namespace Petrosian {
+
+/**
+ * @struct RadiusResult
+ * @brief
+ *  Radii measured from the growth curve of a source, in the same units as the ellipse scale factor
+ */
+struct RadiusResult {
+  /// Petrosian radius, before scaling
+  double m_petrosian_radius;
+  /// Radii that enclose 50% and 90% of the flux within the Petrosian aperture
+  double m_r50, m_r90;
+  /// Rings evaluated to find the Petrosian radius
+  unsigned m_rings;
+  /// How the radii were obtained
+  RadiusFlags m_flags;
+};
+
+/**
+ * @class RadiusMeasurement
+ * @brief
+ *  Computes the Petrosian radius of a source from its growth curve.
+ * @details
+ *  It does not need any pixel: the growth curve has already been built by ProfileMeasurement.
+ *  For sources that have not been profiled, the radii are those of a Gaussian with the same
+ *  second moments, which is what the source ellipse describes: its radius is in units of σ
+ */
+class RadiusMeasurement {
+
+public:
+
+  /**
+   * Constructor
+   * @param eta
+   *    η
+   * @param factor
+   *    \f$N_{\rm P}\f$
+   * @param minrad
+   *    Minimum radius
+   * @param search_mode
+   *    Strategy used to look for the radius
+   */
+  RadiusMeasurement(double eta, double factor, double minrad, RadiusSearchMode search_mode);
+
+  /**
+   * Compute the Petrosian radius, and the light radii from the same growth curve
+   * @param curve
+   *    Growth curve of the source
+   * @return
+   *    The Petrosian radius, before scaling, and the light radii
+   */
+  RadiusResult measure(const GrowthCurve& curve) const;
+
+  /**
+   * @return The radii of a source that has not been profiled, flagged as ESTIMATED
+   */
+  RadiusResult estimate() const;
+
+  /**
+   * Set the PetrosianRadius and PetrosianLightRadii properties of the source
+   */
+  void setProperties(SourceXtractor::SourceInterface& source, const RadiusResult& result) const;
+
+  /**
+   * @return The radius of the photometry aperture for a given Petrosian radius: scaled by
+   *    the Petrosian factor, but not smaller than the minimum radius
+   */
+  double getApertureRadius(double petrosian_radius) const;
+
+private:
+  double m_eta, m_factor, m_minrad;
+  RadiusSearchMode m_search_mode;
+  /// Petrosian radius of a Gaussian, in units of σ. It only depends on η
+  double m_gaussian_radius;
+};
+
+}  // namespace Petrosian
+
+#endif
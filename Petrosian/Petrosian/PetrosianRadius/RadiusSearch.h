@@ -0,0 +1,85 @@
+/**
+ * @file Petrosian/PetrosianRadius/RadiusSearch.h
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _PETROSIAN_PETROSIANRADIUS_RADIUSSEARCH_H
+#define _PETROSIAN_PETROSIANRADIUS_RADIUSSEARCH_H
+
+#include "Petrosian/Common/CumulativeProfile.h"
+
+namespace Petrosian {
+
+// Extent of the profile, in units of the source ellipse, unless it is extended
+static const double PETRO_NSIGMAS = 6.;
+
+/**
+ * Strategies for locating the radius where the surface brightness falls below η times
+ * the mean surface brightness within
+ */
+enum class RadiusSearchMode {
+  /// Walk outwards in fixed steps of 1/20 of PETRO_NSIGMAS, as SExtractor 2 does
+  LEGACY,
+  /// Bracket the crossing with coarse steps, then refine it by bisection and interpolation
+  ADAPTIVE
+};
+
+/**
+ * @struct RadiusSearchResult
+ * @brief
+ *  Outcome of a radius search
+ */
+struct RadiusSearchResult {
+  /// Radius (kmean) at which the η condition is met, or the outermost tested if it is never met
+  double m_radius;
+  /// Number of rings evaluated
+  unsigned m_rings;
+  /// true if the η condition was met within the profile
+  bool m_found;
+};
+
+/**
+ * Look for the Petrosian radius on a cumulative profile.
+ * The step of the search is derived from PETRO_NSIGMAS, and not from the extent of the profile, so it is
+ * the same for profiles that only cover part of it and for those that have been extended
+ * @param profile
+ *    Cumulative profile of the source. No ring goes beyond its maximum radius.
+ * @param eta
+ *    η
+ * @param mode
+ *    Search strategy
+ * @param min_kmin
+ *    Rings starting below this radius are not considered, as the profile may not be accurate there
+ */
+RadiusSearchResult searchPetrosianRadius(const CumulativeProfile& profile, double eta, RadiusSearchMode mode,
+                                         double min_kmin = 0.);
+
+/**
+ * Petrosian radius of a Gaussian, in units of σ, found with the same rings as searchPetrosianRadius but on
+ * the analytic growth curve, so it is on the same scale as the radii measured on profiles
+ * @param eta
+ *    η
+ */
+double getGaussianPetrosianRadius(double eta);
+
+}  // namespace Petrosian
+
+#endif
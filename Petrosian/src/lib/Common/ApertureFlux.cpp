@@ -0,0 +1,405 @@
+/**
+ * @file src/lib/Common/ApertureFlux.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/Common/ApertureFlux.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace Petrosian {
+
+using SourceXtractor::Flags;
+using SourceXtractor::SeFloat;
+
+// Fraction of bad pixels above which the measurement is flagged as biased
+static const double PETRO_BADAREA_THRESHOLD = 0.1;
+
+// Partial measurements of each row block of big stamps
+static thread_local std::vector<ApertureFlux> s_block_fluxes;
+static thread_local std::vector<std::vector<ApertureFlux>> s_block_rings;
+
+/**
+ * Add the pixels of b to a, and merge their flags
+ */
+static void addFlux(ApertureFlux& a, const ApertureFlux& b) {
+  a.m_flux += b.m_flux;
+  a.m_variance += b.m_variance;
+  a.m_total_area += b.m_total_area;
+  a.m_bad_area += b.m_bad_area;
+  a.m_flags |= b.m_flags;
+}
+
+/**
+ * A pixel of the stamp, once bad pixels have been replaced
+ */
+struct PixelSample {
+  SeFloat m_value, m_variance;
+  bool m_bad;
+};
+
+/**
+ * Read the pixel at (x, y), which must be in the stamp. Bad pixels are replaced by their symmetric if
+ * UseSymmetry, and by 0 otherwise. Without symmetry there is no branch, so loops calling it can be vectorized
+ * @param i
+ *    Index of the pixel on image_row and variance_row
+ */
+template <bool UseSymmetry, bool HasVariance>
+static inline PixelSample samplePixel(const ImageStamp& stamp, const SeFloat* image_row, const SeFloat* variance_row,
+                                      int i, int x, int y, SeFloat centroid_x, SeFloat centroid_y,
+                                      SeFloat variance_threshold) {
+  SeFloat value = image_row[i];
+  SeFloat variance = HasVariance ? variance_row[i] : 1;
+  bool bad = variance > variance_threshold;
+  PixelSample sample{bad ? 0 : value, bad ? 0 : variance, bad};
+
+  // Try to replace the pixel with its symmetric
+  if (UseSymmetry && bad) {
+    int mirror_x = static_cast<int>(2 * centroid_x - x + 0.49999);
+    int mirror_y = static_cast<int>(2 * centroid_y - y + 0.49999);
+    if (stamp.contains(mirror_x, mirror_y)) {
+      variance = stamp.getVariance(mirror_x, mirror_y);
+      if (variance < variance_threshold) {
+        sample.m_value = stamp.getValue(mirror_x, mirror_y);
+        sample.m_variance = variance;
+      }
+    }
+  }
+  return sample;
+}
+
+/**
+ * Integrate the pixels of the bounding box of the aperture, each one weighted by
+ * area_of(x, y), the fraction of the pixel inside the aperture.
+ * The options are template parameters so each combination gets its own loop, without
+ * per-pixel branches for the features not used.
+ * @tparam UseSymmetry
+ *    Replace bad pixels with their symmetric with respect to the centroid
+ * Big stamps are integrated by row blocks, as given by blocks.
+ * @tparam HasVariance
+ *    The stamp has a variance map. Otherwise the variance is 1 for all pixels
+ */
+template <bool UseSymmetry, bool HasVariance, typename AreaFunction>
+static ApertureFlux integrateAperture(const EllipseAperture& aperture, const AreaFunction& area_of,
+                                      const ImageStamp& stamp, SeFloat variance_threshold, const RowBlocks& blocks) {
+  auto min_pixel = aperture.getMinPixel();
+  auto max_pixel = aperture.getMaxPixel();
+  auto centroid_x = aperture.getCentroidX();
+  auto centroid_y = aperture.getCentroidY();
+
+  ApertureFlux measurement;
+
+  // Skip if the full source is outside the frame
+  if (max_pixel.m_x < 0 || max_pixel.m_y < 0 ||
+      min_pixel.m_x >= stamp.getImageWidth() || min_pixel.m_y >= stamp.getImageHeight()) {
+    measurement.m_flags = Flags::OUTSIDE;
+    return measurement;
+  }
+
+  // Rows and columns of the bounding box that have been copied into the stamp
+  int stamp_min_x = stamp.getMinX(), stamp_max_x = stamp.getMinX() + stamp.getWidth() - 1;
+  int stamp_min_y = stamp.getMinY(), stamp_max_y = stamp.getMinY() + stamp.getHeight() - 1;
+
+  auto integrate_rows = [&](ApertureFlux& partial, int row_min, int row_max) {
+    for (int y = row_min; y <= row_max; ++y) {
+      // Columns [x0, x1] of the row are in the stamp
+      bool row_in_stamp = y >= stamp_min_y && y <= stamp_max_y;
+      int x0 = row_in_stamp ? std::max(min_pixel.m_x, stamp_min_x) : max_pixel.m_x + 1;
+      int x1 = row_in_stamp ? std::min(max_pixel.m_x, stamp_max_x) : max_pixel.m_x;
+
+      // The stamp is clipped to the image, so the pixels outside are also outside the image.
+      // Only whether the aperture reaches them matters
+      for (int x = min_pixel.m_x; x < x0; ++x) {
+        if (area_of(x, y) > 0) {
+          partial.m_flags |= Flags::BOUNDARY;
+        }
+      }
+      for (int x = x1 + 1; x <= max_pixel.m_x; ++x) {
+        if (area_of(x, y) > 0) {
+          partial.m_flags |= Flags::BOUNDARY;
+        }
+      }
+      if (x0 > x1) {
+        continue;
+      }
+
+      // Pixels outside the aperture are read too, but selected out instead of skipped, so there is no branch
+      const SeFloat* image_row = stamp.getImageRow(y) - stamp_min_x;
+      const SeFloat* variance_row = HasVariance ? stamp.getVarianceRow(y) - stamp_min_x : nullptr;
+      for (int x = x0; x <= x1; ++x) {
+        double area = area_of(x, y);
+        auto sample = samplePixel<UseSymmetry, HasVariance>(stamp, image_row, variance_row, x, x, y,
+                                                            centroid_x, centroid_y, variance_threshold);
+        bool inside = area > 0;
+        partial.m_bad_area += inside && sample.m_bad ? area : 0.;
+        partial.m_total_area += area;
+        partial.m_flux += inside ? sample.m_value * area : 0.;
+        partial.m_variance += inside ? sample.m_variance * area : 0.;
+      }
+    }
+  };
+
+  if (blocks.applies(max_pixel.m_x - min_pixel.m_x + 1, max_pixel.m_y - min_pixel.m_y + 1)) {
+    auto& partials = s_block_fluxes;
+    blocks.reduce(min_pixel.m_y, max_pixel.m_y, partials,
+                  [&integrate_rows](ApertureFlux& partial, int row_min, int row_max) {
+                    partial = ApertureFlux();
+                    integrate_rows(partial, row_min, row_max);
+                  },
+                  addFlux);
+    measurement = partials.front();
+  }
+  else {
+    integrate_rows(measurement, min_pixel.m_y, max_pixel.m_y);
+  }
+
+  if (measurement.m_total_area > 0 && measurement.m_bad_area / measurement.m_total_area > PETRO_BADAREA_THRESHOLD) {
+    measurement.m_flags |= Flags::BIASED;
+  }
+
+  return measurement;
+}
+
+/**
+ * Pick the specialization of integrateAperture for the given options
+ */
+template <typename AreaFunction>
+static ApertureFlux dispatchAperture(const EllipseAperture& aperture, const AreaFunction& area_of,
+                                     const ImageStamp& stamp, SeFloat variance_threshold, bool use_symmetry,
+                                     const RowBlocks& blocks) {
+  if (stamp.hasVariance()) {
+    return use_symmetry ? integrateAperture<true, true>(aperture, area_of, stamp, variance_threshold, blocks)
+                        : integrateAperture<false, true>(aperture, area_of, stamp, variance_threshold, blocks);
+  }
+  return use_symmetry ? integrateAperture<true, false>(aperture, area_of, stamp, variance_threshold, blocks)
+                      : integrateAperture<false, false>(aperture, area_of, stamp, variance_threshold, blocks);
+}
+
+ApertureFlux measureApertureFlux(const EllipseAperture& aperture, const ImageStamp& stamp,
+                                 SeFloat variance_threshold, bool use_symmetry, const RowBlocks& blocks) {
+  auto area_of = [&aperture](int x, int y) {
+    return aperture.getArea(x, y);
+  };
+  return dispatchAperture(aperture, area_of, stamp, variance_threshold, use_symmetry, blocks);
+}
+
+ApertureFlux measureApertureFlux(const EllipseAperture& aperture, const PixelOverlap& overlap,
+                                 const ImageStamp& stamp, SeFloat variance_threshold, bool use_symmetry,
+                                 const RowBlocks& blocks) {
+  auto area_of = [&overlap](int x, int y) {
+    return overlap.getArea(x, y);
+  };
+  return dispatchAperture(aperture, area_of, stamp, variance_threshold, use_symmetry, blocks);
+}
+
+/**
+ * Ring function for apertures with hard edges: a pixel belongs entirely to the ring of the
+ * smallest aperture that contains its center
+ */
+struct HardEdgeRings {
+  const std::vector<EllipseAperture>& m_apertures;
+
+  template <typename AddFunction>
+  void operator()(int x, int y, AddFunction& add) const {
+    // All apertures share the shape, so the left hand side of the equation is the same
+    double r2 = m_apertures.front().getRadiusSquared(x, y);
+    for (size_t i = 0; i < m_apertures.size(); ++i) {
+      double radius = m_apertures[i].getRadius();
+      if (r2 < radius * radius) {
+        add(i, 1.);
+        return;
+      }
+    }
+  }
+};
+
+/**
+ * Ring function for apertures with exact overlap: a pixel crossed by the edge of several apertures
+ * is shared between their rings
+ */
+struct OverlapRings {
+  const std::vector<PixelOverlap>& m_overlaps;
+
+  template <typename AddFunction>
+  void operator()(int x, int y, AddFunction& add) const {
+    double previous = 0.;
+    for (size_t i = 0; i < m_overlaps.size(); ++i) {
+      double area = m_overlaps[i].getArea(x, y);
+      if (area != previous) {
+        add(i, area - previous);
+        previous = area;
+      }
+      // The apertures are nested, so a pixel fully inside one is fully inside the following
+      if (area >= 1.) {
+        return;
+      }
+    }
+  }
+};
+
+/**
+ * Integrate the pixels of the bounding box of the biggest aperture, adding each one to the rings given
+ * by rings_of(x, y, add), which calls add(ring, area) for each ring the pixel overlaps.
+ * @see integrateAperture
+ */
+template <bool UseSymmetry, bool HasVariance, typename RingFunction>
+static void integrateRings(const std::vector<EllipseAperture>& apertures, const RingFunction& rings_of,
+                           const ImageStamp& stamp, SeFloat variance_threshold, const RowBlocks& blocks,
+                           std::vector<ApertureFlux>& fluxes) {
+  // Until the end, fluxes[i] holds the ring between the apertures i - 1 and i
+  fluxes.assign(apertures.size(), ApertureFlux());
+  if (apertures.empty()) {
+    return;
+  }
+
+  const auto& outer = apertures.back();
+  auto min_pixel = outer.getMinPixel();
+  auto max_pixel = outer.getMaxPixel();
+  auto centroid_x = outer.getCentroidX();
+  auto centroid_y = outer.getCentroidY();
+
+  // Skip if the full source is outside the frame, and so are the inner apertures
+  if (max_pixel.m_x < 0 || max_pixel.m_y < 0 ||
+      min_pixel.m_x >= stamp.getImageWidth() || min_pixel.m_y >= stamp.getImageHeight()) {
+    for (auto& measurement : fluxes) {
+      measurement.m_flags = Flags::OUTSIDE;
+    }
+    return;
+  }
+
+  int stamp_min_x = stamp.getMinX(), stamp_max_x = stamp.getMinX() + stamp.getWidth() - 1;
+  int stamp_min_y = stamp.getMinY(), stamp_max_y = stamp.getMinY() + stamp.getHeight() - 1;
+
+  auto integrate_rows = [&](std::vector<ApertureFlux>& rings, int row_min, int row_max) {
+    for (int y = row_min; y <= row_max; ++y) {
+      // Columns [x0, x1] of the row are in the stamp, as for integrateAperture
+      bool row_in_stamp = y >= stamp_min_y && y <= stamp_max_y;
+      int x0 = row_in_stamp ? std::max(min_pixel.m_x, stamp_min_x) : max_pixel.m_x + 1;
+      int x1 = row_in_stamp ? std::min(max_pixel.m_x, stamp_max_x) : max_pixel.m_x;
+
+      auto flag_boundary = [&rings](size_t ring, double) {
+        rings[ring].m_flags |= Flags::BOUNDARY;
+      };
+      for (int x = min_pixel.m_x; x < x0; ++x) {
+        rings_of(x, y, flag_boundary);
+      }
+      for (int x = x1 + 1; x <= max_pixel.m_x; ++x) {
+        rings_of(x, y, flag_boundary);
+      }
+      if (x0 > x1) {
+        continue;
+      }
+
+      // Each pixel is read once, and then added to the rings it overlaps
+      const SeFloat* image_row = stamp.getImageRow(y) - stamp_min_x;
+      const SeFloat* variance_row = HasVariance ? stamp.getVarianceRow(y) - stamp_min_x : nullptr;
+      for (int x = x0; x <= x1; ++x) {
+        auto sample = samplePixel<UseSymmetry, HasVariance>(stamp, image_row, variance_row, x, x, y,
+                                                            centroid_x, centroid_y, variance_threshold);
+        auto add = [&rings, &sample](size_t ring, double area) {
+          auto& measurement = rings[ring];
+          measurement.m_bad_area += sample.m_bad ? area : 0.;
+          measurement.m_total_area += area;
+          measurement.m_flux += sample.m_value * area;
+          measurement.m_variance += sample.m_variance * area;
+        };
+        rings_of(x, y, add);
+      }
+    }
+  };
+
+  if (blocks.applies(max_pixel.m_x - min_pixel.m_x + 1, max_pixel.m_y - min_pixel.m_y + 1)) {
+    auto& partials = s_block_rings;
+    blocks.reduce(min_pixel.m_y, max_pixel.m_y, partials,
+                  [&integrate_rows, &apertures](std::vector<ApertureFlux>& partial, int row_min, int row_max) {
+                    partial.assign(apertures.size(), ApertureFlux());
+                    integrate_rows(partial, row_min, row_max);
+                  },
+                  [](std::vector<ApertureFlux>& a, const std::vector<ApertureFlux>& b) {
+                    for (size_t i = 0; i < a.size(); ++i) {
+                      addFlux(a[i], b[i]);
+                    }
+                  });
+    fluxes = partials.front();
+  }
+  else {
+    integrate_rows(fluxes, min_pixel.m_y, max_pixel.m_y);
+  }
+
+  // Each aperture is the sum of its ring and all the inner ones
+  for (size_t i = 1; i < fluxes.size(); ++i) {
+    addFlux(fluxes[i], fluxes[i - 1]);
+  }
+
+  // The flags that depend on the whole aperture are set as integrateAperture does
+  for (size_t i = 0; i < fluxes.size(); ++i) {
+    auto& measurement = fluxes[i];
+    auto aperture_min = apertures[i].getMinPixel();
+    auto aperture_max = apertures[i].getMaxPixel();
+    if (aperture_max.m_x < 0 || aperture_max.m_y < 0 ||
+        aperture_min.m_x >= stamp.getImageWidth() || aperture_min.m_y >= stamp.getImageHeight()) {
+      measurement = ApertureFlux();
+      measurement.m_flags = Flags::OUTSIDE;
+    }
+    else if (measurement.m_total_area > 0 &&
+             measurement.m_bad_area / measurement.m_total_area > PETRO_BADAREA_THRESHOLD) {
+      measurement.m_flags |= Flags::BIASED;
+    }
+  }
+}
+
+/**
+ * Pick the specialization of integrateRings for the given options
+ */
+template <typename RingFunction>
+static void dispatchRings(const std::vector<EllipseAperture>& apertures, const RingFunction& rings_of,
+                          const ImageStamp& stamp, SeFloat variance_threshold, bool use_symmetry,
+                          const RowBlocks& blocks, std::vector<ApertureFlux>& fluxes) {
+  if (stamp.hasVariance()) {
+    if (use_symmetry) {
+      integrateRings<true, true>(apertures, rings_of, stamp, variance_threshold, blocks, fluxes);
+    }
+    else {
+      integrateRings<false, true>(apertures, rings_of, stamp, variance_threshold, blocks, fluxes);
+    }
+  }
+  else if (use_symmetry) {
+    integrateRings<true, false>(apertures, rings_of, stamp, variance_threshold, blocks, fluxes);
+  }
+  else {
+    integrateRings<false, false>(apertures, rings_of, stamp, variance_threshold, blocks, fluxes);
+  }
+}
+
+void measureApertureFluxes(const std::vector<EllipseAperture>& apertures, const ImageStamp& stamp,
+                           SeFloat variance_threshold, bool use_symmetry, std::vector<ApertureFlux>& fluxes,
+                           const RowBlocks& blocks) {
+  dispatchRings(apertures, HardEdgeRings{apertures}, stamp, variance_threshold, use_symmetry, blocks, fluxes);
+}
+
+void measureApertureFluxes(const std::vector<EllipseAperture>& apertures, const std::vector<PixelOverlap>& overlaps,
+                           const ImageStamp& stamp, SeFloat variance_threshold, bool use_symmetry,
+                           std::vector<ApertureFlux>& fluxes, const RowBlocks& blocks) {
+  dispatchRings(apertures, OverlapRings{overlaps}, stamp, variance_threshold, use_symmetry, blocks, fluxes);
+}
+
+}  // namespace Petrosian
@@ -0,0 +1,100 @@
+/**
+ * @file src/lib/Common/CheckImageSink.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include "Petrosian/Common/CheckImageSink.h"
+#include "Petrosian/Common/EllipseSpans.h"
+#include "Petrosian/Common/GlobalLock.h"
+
+#include <SEImplementation/CheckImages/CheckImages.h>
+
+namespace Petrosian {
+
+// Spans rasterized by each thread before queueing them, reused between calls
+static thread_local std::vector<PixelSpan> s_spans;
+
+CheckImageSink::CheckImageSink(std::string name) : m_name(std::move(name)) {}
+
+void CheckImageSink::fillAperture(const EllipseAperture& aperture, int width, int height, float value) {
+  EllipseSpans ellipse(aperture.getCxx(), aperture.getCyy(), aperture.getCxy(), aperture.getRadius(),
+                       aperture.getCentroidX(), aperture.getCentroidY());
+  ellipse.clip({0, 0}, {width - 1, height - 1});
+
+  auto& spans = s_spans;
+  spans.clear();
+  for (int y = ellipse.getMinY(); y <= ellipse.getMaxY(); ++y) {
+    spans.emplace_back(ellipse.getSpan(y));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (int y = ellipse.getMinY(), i = 0; y <= ellipse.getMaxY(); ++y, ++i) {
+      if (!spans[i].empty()) {
+        m_pending.push_back({y, spans[i].m_x0, spans[i].m_x1, value});
+      }
+    }
+    // Someone else is writing, and will pick up these spans before leaving
+    if (m_draining) {
+      return;
+    }
+    m_draining = true;
+  }
+
+  drain(width, height);
+}
+
+void CheckImageSink::drain(int width, int height) {
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      // Checked and cleared under the same lock as the producers, so no span is left behind
+      if (m_pending.empty()) {
+        m_draining = false;
+        return;
+      }
+      std::swap(m_pending, m_writing);
+    }
+
+    try {
+      GlobalLock lock;
+      if (!m_image) {
+        m_image = SourceXtractor::CheckImages::getInstance().getWriteableCheckImage(m_name, width, height);
+      }
+      for (const auto& span : m_writing) {
+        for (int x = span.m_x0; x < span.m_x1; ++x) {
+          m_image->setValue(x, span.m_y, span.m_value);
+        }
+      }
+    }
+    catch (...) {
+      // Let the next caller try again
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_draining = false;
+      m_writing.clear();
+      throw;
+    }
+    m_writing.clear();
+  }
+}
+
+}  // namespace Petrosian
@@ -0,0 +1,125 @@
+/**
+ * @file src/lib/Common/CumulativeProfile.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/Common/CumulativeProfile.h"
+
+#include <cmath>
+
+namespace Petrosian {
+
+CumulativeProfile::CumulativeProfile(double max_radius, unsigned nbins) {
+  reset(max_radius, nbins);
+}
+
+void CumulativeProfile::reset(double max_radius, unsigned nbins) {
+  m_nbins = nbins;
+  m_max_r2 = max_radius * max_radius;
+  m_inv_bin_width = nbins / m_max_r2;
+  m_flux.assign(nbins + 1, 0.);
+  m_area.assign(nbins + 1, 0.);
+  m_accumulated = 0;
+  m_first_bin = 1;
+}
+
+void CumulativeProfile::reset(const CumulativeProfile& other) {
+  m_nbins = other.m_nbins;
+  m_max_r2 = other.m_max_r2;
+  m_inv_bin_width = other.m_inv_bin_width;
+  m_flux.assign(m_nbins + 1, 0.);
+  m_area.assign(m_nbins + 1, 0.);
+  m_accumulated = 0;
+  m_first_bin = std::max<size_t>(other.m_accumulated, 1);
+}
+
+void CumulativeProfile::merge(const CumulativeProfile& other) {
+  for (size_t i = std::max<size_t>(m_accumulated, 1); i < m_flux.size(); ++i) {
+    m_flux[i] += other.m_flux[i];
+    m_area[i] += other.m_area[i];
+  }
+}
+
+void CumulativeProfile::extend(double max_radius) {
+  double max_r2 = max_radius * max_radius;
+  if (max_r2 <= m_max_r2) {
+    return;
+  }
+  // The bin width does not change, so the existing bins stay where they are
+  m_nbins = static_cast<size_t>(std::ceil(max_r2 * m_inv_bin_width));
+  m_max_r2 = m_nbins / m_inv_bin_width;
+  m_flux.resize(m_nbins + 1, 0.);
+  m_area.resize(m_nbins + 1, 0.);
+}
+
+void CumulativeProfile::accumulate() {
+  for (size_t i = std::max<size_t>(m_accumulated, 1); i < m_flux.size(); ++i) {
+    m_flux[i] += m_flux[i - 1];
+    m_area[i] += m_area[i - 1];
+  }
+  m_accumulated = m_flux.size();
+  m_first_bin = m_accumulated;
+}
+
+double CumulativeProfile::interpolate(const std::vector<double>& cumulative, double radius) const {
+  double position = radius * radius * m_inv_bin_width;
+  if (position >= m_nbins) {
+    return cumulative.back();
+  }
+  // Pixels are assumed to be evenly spread in r^2 within the bin
+  auto bin = static_cast<size_t>(position);
+  double fraction = position - bin;
+  return cumulative[bin] + fraction * (cumulative[bin + 1] - cumulative[bin]);
+}
+
+double CumulativeProfile::getFlux(double radius) const {
+  return interpolate(m_flux, radius);
+}
+
+double CumulativeProfile::getArea(double radius) const {
+  return interpolate(m_area, radius);
+}
+
+double CumulativeProfile::getRadius(double flux, double min_radius, double max_radius) const {
+  max_radius = std::min(max_radius, getMaxRadius());
+  if (getFlux(min_radius) >= flux) {
+    return min_radius;
+  }
+
+  // Walk the bins until the cumulative flux crosses the target, and interpolate within that bin as
+  // getFlux does, so both are consistent
+  auto first_bin = static_cast<size_t>(min_radius * min_radius * m_inv_bin_width);
+  auto last_bin = std::min(static_cast<size_t>(max_radius * max_radius * m_inv_bin_width), m_nbins - 1);
+  for (size_t bin = first_bin; bin <= last_bin; ++bin) {
+    if (m_flux[bin + 1] >= flux) {
+      double fraction = (flux - m_flux[bin]) / (m_flux[bin + 1] - m_flux[bin]);
+      double radius = std::sqrt((bin + std::max(fraction, 0.)) / m_inv_bin_width);
+      return std::min(std::max(radius, min_radius), max_radius);
+    }
+  }
+  return max_radius;
+}
+
+double CumulativeProfile::getMaxRadius() const {
+  return std::sqrt(m_max_r2);
+}
+
+}  // namespace Petrosian
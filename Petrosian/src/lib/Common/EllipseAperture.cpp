@@ -0,0 +1,81 @@
+/**
+ * @file src/lib/Common/EllipseAperture.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include "Petrosian/Common/EllipseAperture.h"
+
+#include <SEFramework/Aperture/EllipticalAperture.h>
+#include <SEFramework/Aperture/TransformedAperture.h>
+#include <cmath>
+
+namespace Petrosian {
+
+EllipseAperture::EllipseAperture(double cxx, double cyy, double cxy, double radius, double centroid_x,
+                                 double centroid_y)
+  : m_cxx(cxx), m_cyy(cyy), m_cxy(cxy), m_radius(radius), m_r2(radius * radius),
+    m_centroid_x(centroid_x), m_centroid_y(centroid_y) {
+}
+
+EllipseAperture EllipseAperture::transform(double cxx, double cyy, double cxy, double radius,
+                                           const std::tuple<double, double, double, double>& jacobian,
+                                           double centroid_x, double centroid_y) {
+  // Measuring on the detection frame, or one aligned with it
+  if (jacobian == std::make_tuple(1., 0., 0., 1.)) {
+    return {cxx, cyy, cxy, radius, centroid_x, centroid_y};
+  }
+
+  // Let SourceXtractor apply the Jacobian, so the convention is the same as for its own apertures.
+  // The radius squared is still a quadratic form on the distance to the center, so three points are
+  // enough to recover its coefficients. The decorated aperture lives on the stack, so it is
+  // given a shared pointer that does not own it.
+  SourceXtractor::EllipticalAperture elliptical(cxx, cyy, cxy, radius);
+  SourceXtractor::TransformedAperture transformed(
+    std::shared_ptr<SourceXtractor::Aperture>(std::shared_ptr<SourceXtractor::Aperture>(), &elliptical), jacobian
+  );
+  auto cx = static_cast<SourceXtractor::SeFloat>(centroid_x);
+  auto cy = static_cast<SourceXtractor::SeFloat>(centroid_y);
+  double tcxx = transformed.getRadiusSquared(cx, cy, cx + 1, cy);
+  double tcyy = transformed.getRadiusSquared(cx, cy, cx, cy + 1);
+  double tcxy = transformed.getRadiusSquared(cx, cy, cx + 1, cy + 1) - tcxx - tcyy;
+  return {tcxx, tcyy, tcxy, radius, centroid_x, centroid_y};
+}
+
+SourceXtractor::PixelCoordinate EllipseAperture::getMinPixel() const {
+  double det = m_cxx * m_cyy - m_cxy * m_cxy / 4.;
+  if (det <= 0) {
+    return {static_cast<int>(m_centroid_x), static_cast<int>(m_centroid_y)};
+  }
+  return {static_cast<int>(std::floor(m_centroid_x - m_radius * std::sqrt(m_cyy / det))),
+          static_cast<int>(std::floor(m_centroid_y - m_radius * std::sqrt(m_cxx / det)))};
+}
+
+SourceXtractor::PixelCoordinate EllipseAperture::getMaxPixel() const {
+  double det = m_cxx * m_cyy - m_cxy * m_cxy / 4.;
+  if (det <= 0) {
+    return {static_cast<int>(m_centroid_x), static_cast<int>(m_centroid_y)};
+  }
+  return {static_cast<int>(std::ceil(m_centroid_x + m_radius * std::sqrt(m_cyy / det))),
+          static_cast<int>(std::ceil(m_centroid_y + m_radius * std::sqrt(m_cxx / det)))};
+}
+
+}  // namespace Petrosian
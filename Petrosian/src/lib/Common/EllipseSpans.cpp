@@ -0,0 +1,85 @@
+/**
+ * @file src/lib/Common/EllipseSpans.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/Common/EllipseSpans.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Petrosian {
+
+EllipseSpans::EllipseSpans(double cxx, double cyy, double cxy, double radius, double centroid_x, double centroid_y)
+  : m_cxx(cxx), m_cxy(cxy), m_cyy(cyy), m_r2(radius * radius),
+    m_centroid_x(centroid_x), m_centroid_y(centroid_y) {
+  // Half sizes of the bounding box
+  double det = cxx * cyy - cxy * cxy / 4.;
+  if (det <= 0 || cxx <= 0 || radius <= 0) {
+    m_min_x = m_min_y = 0;
+    m_max_x = m_max_y = -1;
+    return;
+  }
+  double half_width = radius * std::sqrt(cyy / det);
+  double half_height = radius * std::sqrt(cxx / det);
+
+  m_min_x = static_cast<int>(std::ceil(centroid_x - half_width));
+  m_max_x = static_cast<int>(std::floor(centroid_x + half_width));
+  m_min_y = static_cast<int>(std::ceil(centroid_y - half_height));
+  m_max_y = static_cast<int>(std::floor(centroid_y + half_height));
+}
+
+void EllipseSpans::clip(const SourceXtractor::PixelCoordinate& min_pixel,
+                        const SourceXtractor::PixelCoordinate& max_pixel) {
+  m_min_x = std::max(m_min_x, min_pixel.m_x);
+  m_max_x = std::min(m_max_x, max_pixel.m_x);
+  m_min_y = std::max(m_min_y, min_pixel.m_y);
+  m_max_y = std::min(m_max_y, max_pixel.m_y);
+}
+
+PixelSpan EllipseSpans::getSpan(int y) const {
+  // Solve cxx dx^2 + (cxy dy) dx + (cyy dy^2 - R^2) <= 0 for dx
+  double dy = y - m_centroid_y;
+  double b = m_cxy * dy;
+  double c = m_cyy * dy * dy - m_r2;
+  double discriminant = b * b - 4 * m_cxx * c;
+  if (discriminant < 0) {
+    return {0, 0};
+  }
+  double root = std::sqrt(discriminant);
+  double x0 = m_centroid_x + (-b - root) / (2 * m_cxx);
+  double x1 = m_centroid_x + (-b + root) / (2 * m_cxx);
+
+  return {
+    std::max(static_cast<int>(std::ceil(x0)), m_min_x),
+    std::min(static_cast<int>(std::floor(x1)) + 1, m_max_x + 1)
+  };
+}
+
+SourceXtractor::PixelCoordinate EllipseSpans::getMinPixel() const {
+  return {m_min_x, m_min_y};
+}
+
+SourceXtractor::PixelCoordinate EllipseSpans::getMaxPixel() const {
+  return {m_max_x, m_max_y};
+}
+
+}  // namespace Petrosian
@@ -0,0 +1,55 @@
+/**
+ * @file src/lib/Common/GlobalLock.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/Common/GlobalLock.h"
+#include "Petrosian/Common/TaskStatistics.h"
+
+#include <atomic>
+
+#include <SEImplementation/Measurement/MultithreadedMeasurement.h>
+
+namespace Petrosian {
+
+static std::atomic<uint64_t> s_acquisitions{0}, s_contentions{0};
+
+GlobalLock::GlobalLock()
+  : m_lock(SourceXtractor::MultithreadedMeasurement::g_global_mutex, std::try_to_lock), m_wait_time(0) {
+  ++s_acquisitions;
+  if (!m_lock.owns_lock()) {
+    // The clock is only read when there is something to wait for
+    ++s_contentions;
+    Stopwatch stopwatch;
+    m_lock.lock();
+    m_wait_time = stopwatch.elapsed();
+  }
+}
+
+uint64_t GlobalLock::getAcquisitions() {
+  return s_acquisitions;
+}
+
+uint64_t GlobalLock::getContentions() {
+  return s_contentions;
+}
+
+}  // namespace Petrosian
@@ -0,0 +1,86 @@
+/**
+ * @file src/lib/Common/GroupStamps.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include "Petrosian/Common/GroupStamps.h"
+
+#include <algorithm>
+
+namespace Petrosian {
+
+// A shared stamp is used as long as it is no bigger than this factor times the members' regions together
+static const double PETRO_GROUP_STAMP_OVERHEAD = 2.;
+
+void GroupStamps::clear() {
+  m_min_pixels.clear();
+  m_max_pixels.clear();
+  m_nstamps = 0;
+}
+
+void GroupStamps::add(const SourceXtractor::PixelCoordinate& min_pixel,
+                      const SourceXtractor::PixelCoordinate& max_pixel) {
+  m_min_pixels.emplace_back(min_pixel);
+  m_max_pixels.emplace_back(max_pixel);
+}
+
+void GroupStamps::copy(const std::shared_ptr<SourceXtractor::Image<SourceXtractor::SeFloat>>& image,
+                       const std::shared_ptr<SourceXtractor::Image<SourceXtractor::SeFloat>>& variance,
+                       const std::shared_ptr<SourceXtractor::Image<SourceXtractor::SeFloat>>& thresholded) {
+  m_nstamps = 0;
+  if (m_min_pixels.empty()) {
+    return;
+  }
+
+  // Bounding box of all the regions, and their total area
+  auto min_pixel = m_min_pixels.front();
+  auto max_pixel = m_max_pixels.front();
+  double members_area = 0.;
+  for (size_t i = 0; i < m_min_pixels.size(); ++i) {
+    min_pixel.m_x = std::min(min_pixel.m_x, m_min_pixels[i].m_x);
+    min_pixel.m_y = std::min(min_pixel.m_y, m_min_pixels[i].m_y);
+    max_pixel.m_x = std::max(max_pixel.m_x, m_max_pixels[i].m_x);
+    max_pixel.m_y = std::max(max_pixel.m_y, m_max_pixels[i].m_y);
+    members_area += double(m_max_pixels[i].m_x - m_min_pixels[i].m_x + 1) *
+                    (m_max_pixels[i].m_y - m_min_pixels[i].m_y + 1);
+  }
+  double group_area = double(max_pixel.m_x - min_pixel.m_x + 1) * (max_pixel.m_y - min_pixel.m_y + 1);
+
+  if (group_area <= PETRO_GROUP_STAMP_OVERHEAD * members_area) {
+    m_nstamps = 1;
+    if (m_stamps.size() < m_nstamps) {
+      m_stamps.resize(m_nstamps);
+    }
+    m_stamps.front().copy(image, variance, min_pixel, max_pixel, thresholded);
+  }
+  else {
+    m_nstamps = m_min_pixels.size();
+    if (m_stamps.size() < m_nstamps) {
+      m_stamps.resize(m_nstamps);
+    }
+    for (size_t i = 0; i < m_nstamps; ++i) {
+      m_stamps[i].copy(image, variance, m_min_pixels[i], m_max_pixels[i], thresholded);
+    }
+  }
+}
+
+}  // namespace Petrosian
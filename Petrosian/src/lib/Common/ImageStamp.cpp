@@ -0,0 +1,95 @@
+/**
+ * @file src/lib/Common/ImageStamp.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/Common/ImageStamp.h"
+
+#include <algorithm>
+
+namespace Petrosian {
+
+using SourceXtractor::SeFloat;
+
+/**
+ * Copy a region of an image into a row-major buffer with a single chunk request
+ */
+static void copyChunk(const std::shared_ptr<SourceXtractor::Image<SeFloat>>& image,
+                      int x, int y, int width, int height, std::vector<SeFloat>& buffer) {
+  buffer.resize(width * height);
+  if (buffer.empty()) {
+    return;
+  }
+  auto chunk = image->getChunk(x, y, width, height);
+  auto output = buffer.begin();
+  for (int iy = 0; iy < height; ++iy) {
+    for (int ix = 0; ix < width; ++ix) {
+      *output++ = chunk->getValue(ix, iy);
+    }
+  }
+}
+
+ImageStamp::ImageStamp(const std::shared_ptr<SourceXtractor::Image<SeFloat>>& image,
+                       const std::shared_ptr<SourceXtractor::Image<SeFloat>>& variance,
+                       const SourceXtractor::PixelCoordinate& min_pixel,
+                       const SourceXtractor::PixelCoordinate& max_pixel,
+                       const std::shared_ptr<SourceXtractor::Image<SeFloat>>& thresholded) {
+  copy(image, variance, min_pixel, max_pixel, thresholded);
+}
+
+ImageStamp::ImageStamp()
+  : m_min_x(0), m_min_y(0), m_width(0), m_height(0), m_image_width(0), m_image_height(0) {
+}
+
+void ImageStamp::copy(const std::shared_ptr<SourceXtractor::Image<SeFloat>>& image,
+                      const std::shared_ptr<SourceXtractor::Image<SeFloat>>& variance,
+                      const SourceXtractor::PixelCoordinate& min_pixel,
+                      const SourceXtractor::PixelCoordinate& max_pixel,
+                      const std::shared_ptr<SourceXtractor::Image<SeFloat>>& thresholded) {
+  m_image_width = image->getWidth();
+  m_image_height = image->getHeight();
+
+  // Clip to the image
+  m_min_x = std::max(min_pixel.m_x, 0);
+  m_min_y = std::max(min_pixel.m_y, 0);
+  m_width = std::max(std::min(max_pixel.m_x, m_image_width - 1) - m_min_x + 1, 0);
+  m_height = std::max(std::min(max_pixel.m_y, m_image_height - 1) - m_min_y + 1, 0);
+  if (m_width == 0 || m_height == 0) {
+    m_width = m_height = 0;
+  }
+
+  copyChunk(image, m_min_x, m_min_y, m_width, m_height, m_image);
+  // clear() keeps the capacity, so the buffers are still there for the next copy
+  if (variance) {
+    copyChunk(variance, m_min_x, m_min_y, m_width, m_height, m_variance);
+  }
+  else {
+    m_variance.clear();
+  }
+  if (thresholded) {
+    copyChunk(thresholded, m_min_x, m_min_y, m_width, m_height, m_thresholded);
+  }
+  else {
+    m_thresholded.clear();
+  }
+}
+
+}  // namespace Petrosian
@@ -0,0 +1,185 @@
+/**
+ * @file src/lib/Common/PixelOverlap.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include "Petrosian/Common/PixelOverlap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace Petrosian {
+
+// Number of steps of the table along the direction of the edge, and along its distance
+static const int PETRO_OVERLAP_SLOPES = 64;
+static const int PETRO_OVERLAP_DISTANCES = 256;
+
+// Half of the diagonal of a pixel: any line further away than this from its center does not cross it
+static const double PETRO_HALF_DIAGONAL = std::sqrt(0.5);
+
+// The error of the tangent approximation goes as the square of the pixel size over the radius of curvature
+// of the edge. Pixels are split so their side squared is below this constant times the radius of curvature,
+// which keeps the error within about 1% of a pixel
+static const double PETRO_OVERLAP_CURVATURE = 0.125;
+static const int PETRO_OVERLAP_MAX_SUBDIVISION = 4;
+
+/**
+ * Exact area of the unit square centered on the origin, on the side a * x + b * y <= d.
+ * (a, b) is the unit normal of the line, with a >= b >= 0
+ */
+static double halfPlaneArea(double a, double b, double d) {
+  // Shift so u goes from 0 (line touching the first corner) to a + b (touching the last)
+  double u = d + (a + b) / 2;
+  if (u <= 0) {
+    return 0.;
+  }
+  if (u >= a + b) {
+    return 1.;
+  }
+  if (b == 0) {
+    return u / a;
+  }
+  if (u <= b) {
+    return u * u / (2 * a * b);
+  }
+  if (u <= a) {
+    return (u - b / 2) / a;
+  }
+  double v = a + b - u;
+  return 1. - v * v / (2 * a * b);
+}
+
+/**
+ * Table of the area, indexed by the slope b / a of the normal, and the distance of the line
+ * to the center of the pixel, from -PETRO_HALF_DIAGONAL to PETRO_HALF_DIAGONAL
+ */
+static const std::vector<float>& getOverlapTable() {
+  // Built only once, the first time it is needed. C++11 guarantees this is thread safe
+  static const std::vector<float> table = []() {
+    std::vector<float> values((PETRO_OVERLAP_SLOPES + 1) * (PETRO_OVERLAP_DISTANCES + 1));
+    for (int i = 0; i <= PETRO_OVERLAP_SLOPES; ++i) {
+      double slope = static_cast<double>(i) / PETRO_OVERLAP_SLOPES;
+      double a = 1. / std::sqrt(1. + slope * slope);
+      double b = slope * a;
+      for (int j = 0; j <= PETRO_OVERLAP_DISTANCES; ++j) {
+        double d = PETRO_HALF_DIAGONAL * (2. * j / PETRO_OVERLAP_DISTANCES - 1.);
+        values[i * (PETRO_OVERLAP_DISTANCES + 1) + j] = static_cast<float>(halfPlaneArea(a, b, d));
+      }
+    }
+    return values;
+  }();
+  return table;
+}
+
+/**
+ * Bilinear interpolation on the table of areas. (nx, ny) is the normal of the line, not necessarily unitary
+ */
+static double lookupArea(double nx, double ny, double distance) {
+  // By symmetry of the square, only the absolute value of the components matters, and they can be swapped
+  nx = std::abs(nx);
+  ny = std::abs(ny);
+  double slope = nx > ny ? ny / nx : nx / ny;
+
+  double si = slope * PETRO_OVERLAP_SLOPES;
+  double di = (distance / PETRO_HALF_DIAGONAL + 1.) * PETRO_OVERLAP_DISTANCES / 2;
+  if (di <= 0) {
+    return 0.;
+  }
+  if (di >= PETRO_OVERLAP_DISTANCES) {
+    return 1.;
+  }
+
+  int i = std::min(static_cast<int>(si), PETRO_OVERLAP_SLOPES - 1);
+  int j = std::min(static_cast<int>(di), PETRO_OVERLAP_DISTANCES - 1);
+  double fi = si - i, fj = di - j;
+
+  const auto& table = getOverlapTable();
+  const float* row0 = table.data() + i * (PETRO_OVERLAP_DISTANCES + 1) + j;
+  const float* row1 = row0 + PETRO_OVERLAP_DISTANCES + 1;
+  double v0 = row0[0] + fj * (row0[1] - row0[0]);
+  double v1 = row1[0] + fj * (row1[1] - row1[0]);
+  return v0 + fi * (v1 - v0);
+}
+
+PixelOverlap::PixelOverlap(const EllipseAperture& ellipse)
+  : m_cxx(ellipse.getCxx()), m_cyy(ellipse.getCyy()), m_cxy(ellipse.getCxy()), m_radius(ellipse.getRadius()),
+    m_centroid_x(ellipse.getCentroidX()), m_centroid_y(ellipse.getCentroidY()) {
+  // sqrt(r2) is a norm, so within a pixel it can not change more than the half diagonal
+  // times the square root of the biggest eigenvalue of the ellipse matrix
+  double half_diff = (m_cxx - m_cyy) / 2;
+  double spread = std::sqrt(half_diff * half_diff + m_cxy * m_cxy / 4);
+  double lambda_max = std::max((m_cxx + m_cyy) / 2 + spread, 0.);
+  double lambda_min = std::max((m_cxx + m_cyy) / 2 - spread, 0.);
+  double margin = std::sqrt(lambda_max) * PETRO_HALF_DIAGONAL;
+
+  double inner = std::max(m_radius - margin, 0.);
+  m_inner_r2 = inner * inner;
+  m_outer_r2 = (m_radius + margin) * (m_radius + margin);
+
+  // The tightest curve is at the end of the major axis, with a radius b^2 / a
+  m_subdivision = PETRO_OVERLAP_MAX_SUBDIVISION;
+  if (lambda_max > 0 && m_radius > 0) {
+    double curvature_radius = m_radius * std::sqrt(lambda_min) / lambda_max;
+    while (m_subdivision > 1 &&
+           PETRO_OVERLAP_CURVATURE * curvature_radius * (m_subdivision - 1) * (m_subdivision - 1) >= 1) {
+      --m_subdivision;
+    }
+  }
+}
+
+double PixelOverlap::getBoundaryArea(double dx, double dy) const {
+  if (m_subdivision == 1) {
+    return getEdgeArea(dx, dy, 1.);
+  }
+
+  double step = 1. / m_subdivision;
+  double first = (step - 1.) / 2;
+  double area = 0.;
+  for (int j = 0; j < m_subdivision; ++j) {
+    for (int i = 0; i < m_subdivision; ++i) {
+      area += getEdgeArea(dx + first + i * step, dy + first + j * step, step);
+    }
+  }
+  return area / (m_subdivision * m_subdivision);
+}
+
+double PixelOverlap::getEdgeArea(double dx, double dy, double scale) const {
+  double r2 = m_cxx * dx * dx + m_cyy * dy * dy + m_cxy * dx * dy;
+
+  // Gradient of r2, normal to the edge
+  double gx = 2 * m_cxx * dx + m_cxy * dy;
+  double gy = 2 * m_cyy * dy + m_cxy * dx;
+  double gnorm = std::sqrt(gx * gx + gy * gy);
+  if (gnorm == 0) {
+    return r2 < m_radius * m_radius ? 1. : 0.;
+  }
+
+  // First order distance from the center of the square to the edge (positive if inside),
+  // in units of the side of the square
+  double r = std::sqrt(r2);
+  double distance = (m_radius - r) * 2 * r / (gnorm * scale);
+
+  return lookupArea(gx, gy, distance);
+}
+
+}  // namespace Petrosian
@@ -0,0 +1,126 @@
+/**
+ * @file src/lib/Common/RowKernel.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/Common/RowKernel.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PETROSIAN_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace Petrosian {
+
+// All implementations must evaluate r2 with the same operations, in the same order,
+// so they give bit-identical results. This is also why this file is compiled without
+// floating point contraction (see CMakeLists.txt): a fused multiply-add rounds differently
+
+// Scalar evaluation of the pixels [begin, n) of the row. Used also for the tail of the vectorized loops
+static void evaluateRowRadiusTail(const EllipseRow& row, int begin, int n, float* r2) {
+  for (int i = begin; i < n; ++i) {
+    float dx = row.dx0 + static_cast<float>(i);
+    r2[i] = row.r2_row + dx * (row.cxx * dx + row.cxy_dy);
+  }
+}
+
+void evaluateRowRadiusScalar(const EllipseRow& row, int n, float* r2) {
+  evaluateRowRadiusTail(row, 0, n, r2);
+}
+
+#ifdef PETROSIAN_X86_DISPATCH
+
+__attribute__((target("sse4.1")))
+static void evaluateRowRadiusSse4(const EllipseRow& row, int n, float* r2) {
+  const __m128 iota = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+  const __m128 dx0 = _mm_set1_ps(row.dx0), cxx = _mm_set1_ps(row.cxx);
+  const __m128 cxy_dy = _mm_set1_ps(row.cxy_dy), r2_row = _mm_set1_ps(row.r2_row);
+
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128 dx = _mm_add_ps(dx0, _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), iota));
+    _mm_storeu_ps(r2 + i, _mm_add_ps(r2_row, _mm_mul_ps(dx, _mm_add_ps(_mm_mul_ps(cxx, dx), cxy_dy))));
+  }
+  evaluateRowRadiusTail(row, i, n, r2);
+}
+
+__attribute__((target("avx2")))
+static void evaluateRowRadiusAvx2(const EllipseRow& row, int n, float* r2) {
+  const __m256 iota = _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f);
+  const __m256 dx0 = _mm256_set1_ps(row.dx0), cxx = _mm256_set1_ps(row.cxx);
+  const __m256 cxy_dy = _mm256_set1_ps(row.cxy_dy), r2_row = _mm256_set1_ps(row.r2_row);
+
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256 dx = _mm256_add_ps(dx0, _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), iota));
+    _mm256_storeu_ps(r2 + i,
+                     _mm256_add_ps(r2_row, _mm256_mul_ps(dx, _mm256_add_ps(_mm256_mul_ps(cxx, dx), cxy_dy))));
+  }
+  evaluateRowRadiusTail(row, i, n, r2);
+}
+
+__attribute__((target("avx512f")))
+static void evaluateRowRadiusAvx512(const EllipseRow& row, int n, float* r2) {
+  const __m512 iota = _mm512_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f,
+                                     8.f, 9.f, 10.f, 11.f, 12.f, 13.f, 14.f, 15.f);
+  const __m512 dx0 = _mm512_set1_ps(row.dx0), cxx = _mm512_set1_ps(row.cxx);
+  const __m512 cxy_dy = _mm512_set1_ps(row.cxy_dy), r2_row = _mm512_set1_ps(row.r2_row);
+
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512 dx = _mm512_add_ps(dx0, _mm512_add_ps(_mm512_set1_ps(static_cast<float>(i)), iota));
+    _mm512_storeu_ps(r2 + i,
+                     _mm512_add_ps(r2_row, _mm512_mul_ps(dx, _mm512_add_ps(_mm512_mul_ps(cxx, dx), cxy_dy))));
+  }
+  evaluateRowRadiusTail(row, i, n, r2);
+}
+
+#endif
+
+std::vector<RowKernel> getRowKernels() {
+  std::vector<RowKernel> kernels;
+#ifdef PETROSIAN_X86_DISPATCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    kernels.push_back({"AVX-512", evaluateRowRadiusAvx512});
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    kernels.push_back({"AVX2", evaluateRowRadiusAvx2});
+  }
+  if (__builtin_cpu_supports("sse4.1")) {
+    kernels.push_back({"SSE4.1", evaluateRowRadiusSse4});
+  }
+#endif
+  kernels.push_back({"scalar", evaluateRowRadiusScalar});
+  return kernels;
+}
+
+static const RowKernel s_row_kernel = getRowKernels().front();
+
+void evaluateRowRadius(const EllipseRow& row, int n, float* r2) {
+  s_row_kernel.m_radius(row, n, r2);
+}
+
+const char* getRowKernelName() {
+  return s_row_kernel.m_name;
+}
+
+}  // namespace Petrosian
@@ -0,0 +1,86 @@
+/**
+ * @file src/lib/Common/StampMask.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/Common/StampMask.h"
+
+#include <algorithm>
+
+namespace Petrosian {
+
+void StampMask::build(const ImageStamp& stamp, float variance_threshold,
+                      const SourceXtractor::PixelCoordinate& min_pixel,
+                      const SourceXtractor::PixelCoordinate& max_pixel,
+                      const std::vector<SourceXtractor::PixelCoordinate>* source_pixels) {
+  // Clip to the stamp
+  m_min_x = std::max(min_pixel.m_x, stamp.getMinX());
+  m_min_y = std::max(min_pixel.m_y, stamp.getMinY());
+  m_width = std::max(std::min(max_pixel.m_x, stamp.getMinX() + stamp.getWidth() - 1) - m_min_x + 1, 0);
+  m_height = std::max(std::min(max_pixel.m_y, stamp.getMinY() + stamp.getHeight() - 1) - m_min_y + 1, 0);
+  if (m_width == 0 || m_height == 0) {
+    m_width = m_height = 0;
+  }
+
+  // assign() keeps the capacity, so there is no allocation once the mask is big enough
+  m_row_words = (m_width + 63) / 64;
+  m_usable.assign(m_row_words * m_height, 0);
+  m_neighbour.assign(m_row_words * m_height, 0);
+  m_has_neighbours = false;
+
+  // Neighbours are all the pixels above the detection threshold, except those of the source
+  if (source_pixels && stamp.hasThresholded()) {
+    for (int y = 0; y < m_height; ++y) {
+      const auto* thresholded = stamp.getThresholdedRow(m_min_y + y) + (m_min_x - stamp.getMinX());
+      uint64_t* row = m_neighbour.data() + y * m_row_words;
+      for (int x = 0; x < m_width; ++x) {
+        row[x / 64] |= static_cast<uint64_t>(thresholded[x] > 0) << (x % 64);
+      }
+    }
+    for (const auto& pixel : *source_pixels) {
+      int x = pixel.m_x - m_min_x, y = pixel.m_y - m_min_y;
+      if (x >= 0 && y >= 0 && x < m_width && y < m_height) {
+        m_neighbour[y * m_row_words + x / 64] &= ~(uint64_t(1) << (x % 64));
+      }
+    }
+  }
+
+  // A pixel is usable if its variance is good, and it is not a neighbour's
+  bool default_valid = 1.f < variance_threshold;
+  for (int y = 0; y < m_height; ++y) {
+    const auto* variances = stamp.hasVariance() ?
+                            stamp.getVarianceRow(m_min_y + y) + (m_min_x - stamp.getMinX()) : nullptr;
+    uint64_t* usable = m_usable.data() + y * m_row_words;
+    const uint64_t* neighbour = m_neighbour.data() + y * m_row_words;
+    for (int w = 0; w < m_row_words; ++w) {
+      int begin = w * 64, end = std::min(begin + 64, m_width);
+      uint64_t word = 0;
+      for (int x = begin; x < end; ++x) {
+        bool valid = variances ? variances[x] < variance_threshold : default_valid;
+        word |= static_cast<uint64_t>(valid) << (x - begin);
+      }
+      usable[w] = word & ~neighbour[w];
+      m_has_neighbours |= neighbour[w] != 0;
+    }
+  }
+}
+
+}  // namespace Petrosian
@@ -0,0 +1,160 @@
+/**
+ * @file src/lib/Common/TaskStatistics.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include "Petrosian/Common/TaskStatistics.h"
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Petrosian {
+
+namespace {
+
+/// One bin per power of two: bin 0 holds 0, and bin i the values in [2^(i-1), 2^i)
+static const unsigned HISTOGRAM_BINS = 65;
+
+/**
+ * Counters of one stage, on one thread.
+ * Only the owning thread writes them, so a relaxed load followed by a relaxed store is enough,
+ * and the atomics only make sure the summary does not read torn values
+ */
+struct StageCounters {
+  std::atomic<uint64_t> m_count;
+  std::atomic<uint64_t> m_lock_wait, m_compute, m_pixels, m_rings;
+  std::atomic<uint64_t> m_lock_wait_histogram[HISTOGRAM_BINS];
+  std::atomic<uint64_t> m_compute_histogram[HISTOGRAM_BINS];
+};
+
+struct ThreadCounters {
+  StageCounters m_stages[TaskStatistics::NSTAGES];
+};
+
+}  // namespace
+
+// Never destroyed, so the blocks are still there whatever the order in which the plugin
+// and the threads go away
+static std::mutex& s_registry_mutex = *new std::mutex;
+static std::vector<std::unique_ptr<ThreadCounters>>& s_registry = *new std::vector<std::unique_ptr<ThreadCounters>>;
+
+static thread_local ThreadCounters* s_counters = nullptr;
+
+static ThreadCounters& getThreadCounters() {
+  if (!s_counters) {
+    // Value initialization sets all counters to 0
+    std::unique_ptr<ThreadCounters> counters(new ThreadCounters());
+    s_counters = counters.get();
+    std::lock_guard<std::mutex> lock(s_registry_mutex);
+    s_registry.emplace_back(std::move(counters));
+  }
+  return *s_counters;
+}
+
+static void increment(std::atomic<uint64_t>& counter, uint64_t value) {
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+static unsigned getBin(uint64_t value) {
+  unsigned bin = 0;
+  while (value) {
+    value >>= 1;
+    ++bin;
+  }
+  return bin;
+}
+
+/**
+ * @return The upper bound of the bin where the given fraction of the entries is reached
+ */
+static uint64_t getPercentile(const std::vector<uint64_t>& histogram, uint64_t count, double fraction) {
+  uint64_t target = static_cast<uint64_t>(fraction * count + 0.5), seen = 0;
+  for (unsigned bin = 0; bin < histogram.size(); ++bin) {
+    seen += histogram[bin];
+    if (seen >= target && seen > 0) {
+      if (bin == 0) {
+        return 0;
+      }
+      return bin < 64 ? (uint64_t{1} << bin) - 1 : std::numeric_limits<uint64_t>::max();
+    }
+  }
+  return 0;
+}
+
+void TaskStatistics::record(Stage stage, const TaskCost& cost) {
+  auto& counters = getThreadCounters().m_stages[stage];
+  increment(counters.m_count, 1);
+  increment(counters.m_lock_wait, cost.m_lock_wait);
+  increment(counters.m_compute, cost.m_compute);
+  increment(counters.m_pixels, cost.m_pixels);
+  increment(counters.m_rings, cost.m_rings);
+  increment(counters.m_lock_wait_histogram[getBin(cost.m_lock_wait)], 1);
+  increment(counters.m_compute_histogram[getBin(cost.m_compute)], 1);
+}
+
+TaskStatistics::Summary TaskStatistics::summarize(Stage stage) {
+  Summary summary{0, {0, 0, 0, 0}, 0, 0, 0, 0};
+  std::vector<uint64_t> lock_wait_histogram(HISTOGRAM_BINS), compute_histogram(HISTOGRAM_BINS);
+
+  std::lock_guard<std::mutex> lock(s_registry_mutex);
+  for (const auto& thread_counters : s_registry) {
+    const auto& counters = thread_counters->m_stages[stage];
+    summary.m_count += counters.m_count.load(std::memory_order_relaxed);
+    summary.m_total.m_lock_wait += counters.m_lock_wait.load(std::memory_order_relaxed);
+    summary.m_total.m_compute += counters.m_compute.load(std::memory_order_relaxed);
+    summary.m_total.m_pixels += counters.m_pixels.load(std::memory_order_relaxed);
+    summary.m_total.m_rings += counters.m_rings.load(std::memory_order_relaxed);
+    for (unsigned bin = 0; bin < HISTOGRAM_BINS; ++bin) {
+      lock_wait_histogram[bin] += counters.m_lock_wait_histogram[bin].load(std::memory_order_relaxed);
+      compute_histogram[bin] += counters.m_compute_histogram[bin].load(std::memory_order_relaxed);
+    }
+  }
+
+  summary.m_lock_wait_p50 = getPercentile(lock_wait_histogram, summary.m_count, 0.5);
+  summary.m_lock_wait_p99 = getPercentile(lock_wait_histogram, summary.m_count, 0.99);
+  summary.m_compute_p50 = getPercentile(compute_histogram, summary.m_count, 0.5);
+  summary.m_compute_p99 = getPercentile(compute_histogram, summary.m_count, 0.99);
+  return summary;
+}
+
+const char* TaskStatistics::getStageName(Stage stage) {
+  switch (stage) {
+    case PROFILE:
+      return "profile";
+    case RADIUS:
+      return "radius";
+    case PHOTOMETRY:
+      return "photometry";
+    default:
+      return "unknown";
+  }
+}
+
+size_t TaskStatistics::getThreadCount() {
+  std::lock_guard<std::mutex> lock(s_registry_mutex);
+  return s_registry.size();
+}
+
+}  // namespace Petrosian
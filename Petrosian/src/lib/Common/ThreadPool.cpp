@@ -0,0 +1,141 @@
+/**
+ * @file src/lib/Common/ThreadPool.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include "Petrosian/Common/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace Petrosian {
+
+/**
+ * A call to parallelFor. Threads claim indexes until all have been taken
+ */
+struct ThreadPool::Batch {
+  const std::function<void(size_t)>* m_function;
+  size_t m_size;
+  std::atomic<size_t> m_next{0}, m_done{0};
+  std::exception_ptr m_exception;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+};
+
+ThreadPool::ThreadPool(unsigned nthreads) : m_stop(false) {
+  for (unsigned i = 0; i < nthreads; ++i) {
+    m_threads.emplace_back(&ThreadPool::work, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_condition.notify_all();
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+}
+
+void ThreadPool::run(Batch& batch) {
+  size_t i;
+  while ((i = batch.m_next.fetch_add(1)) < batch.m_size) {
+    try {
+      (*batch.m_function)(i);
+    }
+    catch (...) {
+      std::lock_guard<std::mutex> lock(batch.m_mutex);
+      if (!batch.m_exception) {
+        batch.m_exception = std::current_exception();
+      }
+    }
+    // The last one to finish wakes up the caller
+    if (batch.m_done.fetch_add(1) + 1 == batch.m_size) {
+      std::lock_guard<std::mutex> lock(batch.m_mutex);
+      batch.m_condition.notify_all();
+    }
+  }
+}
+
+void ThreadPool::work() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_condition.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+    if (m_stop) {
+      return;
+    }
+    auto batch = m_queue.front();
+    // Once all indexes have been claimed, there is nothing left to help with
+    if (batch->m_next.load() >= batch->m_size) {
+      m_queue.pop_front();
+      continue;
+    }
+    lock.unlock();
+    run(*batch);
+    lock.lock();
+  }
+}
+
+void ThreadPool::parallelFor(size_t n, const std::function<void(size_t)>& function) {
+  // Not worth waking up anyone
+  if (n <= 1 || m_threads.empty()) {
+    for (size_t i = 0; i < n; ++i) {
+      function(i);
+    }
+    return;
+  }
+
+  auto batch = std::make_shared<Batch>();
+  batch->m_function = &function;
+  batch->m_size = n;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.emplace_back(batch);
+  }
+  m_condition.notify_all();
+
+  run(*batch);
+
+  // The pool threads may still be running the last indexes
+  {
+    std::unique_lock<std::mutex> lock(batch->m_mutex);
+    batch->m_condition.wait(lock, [&batch]() { return batch->m_done.load() == batch->m_size; });
+  }
+
+  // Do not leave it behind for the pool threads to find
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto i = std::find(m_queue.begin(), m_queue.end(), batch);
+    if (i != m_queue.end()) {
+      m_queue.erase(i);
+    }
+  }
+
+  if (batch->m_exception) {
+    std::rethrow_exception(batch->m_exception);
+  }
+}
+
+}  // namespace Petrosian
@@ -22,6 +22,8 @@
  */
 
 #include "Petrosian/PetrosianConfig.h"
+#include <ElementsKernel/Exception.h>
+#include <algorithm>
 
 using namespace Euclid::Configuration;
 namespace po = boost::program_options;
@@ -31,8 +33,26 @@ namespace Petrosian {
 static const char PETROSIAN_ETA[]{"petrosian-eta"};
 static const char PETROSIAN_FACTOR[]{"pretrosian-factor"};
 static const char PETROSIAN_MINRAD[]{"petrosian-minimum-radius"};
+static const char PETROSIAN_FACTORS[]{"petrosian-factors"};
+static const char PETROSIAN_SEARCH[]{"petrosian-search"};
+static const char PETROSIAN_BINNING_AREA[]{"petrosian-binning-area"};
+static const char PETROSIAN_BINNING_FACTOR[]{"petrosian-binning-factor"};
+static const char PETROSIAN_TIER_SNR[]{"petrosian-tier-snr"};
+static const char PETROSIAN_TIER_AREA[]{"petrosian-tier-area"};
+static const char PETROSIAN_MAX_NSIGMAS[]{"petrosian-max-nsigmas"};
+static const char PETROSIAN_EXACT_OVERLAP[]{"petrosian-exact-overlap"};
+static const char PETROSIAN_GROUP_TASKS[]{"petrosian-group-tasks"};
+static const char PETROSIAN_FUSED_PHOTOMETRY[]{"petrosian-fused-photometry"};
+static const char PETROSIAN_BAND_THREADS[]{"petrosian-band-threads"};
+static const char PETROSIAN_BLOCK_AREA[]{"petrosian-block-area"};
+static const char PETROSIAN_BLOCK_THREADS[]{"petrosian-block-threads"};
 static const char PETROSIAN_CHECKIMAGE[]{"check-image-petrosian"};
 
+static const std::map<std::string, RadiusSearchMode> s_search_modes{
+  {"LEGACY", RadiusSearchMode::LEGACY},
+  {"ADAPTIVE", RadiusSearchMode::ADAPTIVE}
+};
+
 PetrosianConfig::PetrosianConfig(long manager_id) : Configuration(manager_id) {}
 
 std::map<std::string, Configuration::OptionDescriptionList> PetrosianConfig::getProgramOptions() {
@@ -54,6 +74,59 @@ std::map<std::string, Configuration::OptionDescriptionList> PetrosianConfig::get
           PETROSIAN_MINRAD, po::value<double>()->default_value(3.5),
           "Minimum radius for Petrosian photometry"
         },
+        {
+          PETROSIAN_FACTORS, po::value<std::vector<double>>()->multitoken()->default_value({}, ""),
+          "Scale factors of additional Petrosian apertures, all measured in one pass"
+        },
+        {
+          PETROSIAN_SEARCH, po::value<std::string>()->default_value("LEGACY"),
+          "Petrosian radius search: LEGACY (fixed steps) or ADAPTIVE (bracketing and bisection)"
+        },
+        {
+          PETROSIAN_BINNING_AREA, po::value<int>()->default_value(0),
+          "Stamps with more pixels than this are first searched binned (0 to disable)"
+        },
+        {
+          PETROSIAN_BINNING_FACTOR, po::value<int>()->default_value(4),
+          "Binning factor for the coarse Petrosian radius search"
+        },
+        {
+          PETROSIAN_TIER_SNR, po::value<double>()->default_value(0.),
+          "Sources with a lower isophotal SNR get a Petrosian radius estimated from their moments (0 to disable)"
+        },
+        {
+          PETROSIAN_TIER_AREA, po::value<int>()->default_value(0),
+          "Sources with fewer detected pixels get a Petrosian radius estimated from their moments (0 to disable)"
+        },
+        {
+          PETROSIAN_MAX_NSIGMAS, po::value<double>()->default_value(6.),
+          "Extent, in units of the source ellipse, up to which the Petrosian profile is extended while the "
+          "radius is not found (6 to disable)"
+        },
+        {
+          PETROSIAN_EXACT_OVERLAP, po::value<bool>()->default_value(false),
+          "Weight the pixels on the edge of the Petrosian aperture by the fraction inside"
+        },
+        {
+          PETROSIAN_GROUP_TASKS, po::value<bool>()->default_value(false),
+          "Measure all the sources of a group together, sharing the image stamps"
+        },
+        {
+          PETROSIAN_FUSED_PHOTOMETRY, po::value<bool>()->default_value(false),
+          "Measure the Petrosian photometry on all frames of a source in one go"
+        },
+        {
+          PETROSIAN_BAND_THREADS, po::value<int>()->default_value(0),
+          "Threads used to measure the frames of a source in parallel (0 to disable)"
+        },
+        {
+          PETROSIAN_BLOCK_AREA, po::value<int>()->default_value(0),
+          "Stamps with more pixels than this are reduced by blocks of rows (0 to disable)"
+        },
+        {
+          PETROSIAN_BLOCK_THREADS, po::value<int>()->default_value(0),
+          "Threads used to reduce the blocks of rows in parallel (0 to disable)"
+        },
         {
           PETROSIAN_CHECKIMAGE, po::value<std::string>(),
           "Check image for Petrosian apertures"
@@ -69,6 +142,55 @@ void PetrosianConfig::initialize(const UserValues& args) {
   m_eta = args.at(PETROSIAN_ETA).as<double>();
   m_factor = args.at(PETROSIAN_FACTOR).as<double>();
   m_minrad = args.at(PETROSIAN_MINRAD).as<double>();
+
+  // The additional apertures keep the order given by the user, which is the order of the output
+  m_factors = args.at(PETROSIAN_FACTORS).as<std::vector<double>>();
+  for (auto factor : m_factors) {
+    if (factor <= 0) {
+      throw Elements::Exception() << "Invalid Petrosian factor " << factor;
+    }
+  }
+
+  auto search_mode = args.at(PETROSIAN_SEARCH).as<std::string>();
+  std::transform(search_mode.begin(), search_mode.end(), search_mode.begin(), ::toupper);
+  auto search_mode_i = s_search_modes.find(search_mode);
+  if (search_mode_i == s_search_modes.end()) {
+    throw Elements::Exception() << "Unknown Petrosian search mode " << search_mode;
+  }
+  m_search_mode = search_mode_i->second;
+
+  m_binning_area = args.at(PETROSIAN_BINNING_AREA).as<int>();
+  m_binning_factor = args.at(PETROSIAN_BINNING_FACTOR).as<int>();
+  if (m_binning_factor < 1) {
+    throw Elements::Exception() << "Invalid Petrosian binning factor " << m_binning_factor;
+  }
+
+  m_tier_snr = args.at(PETROSIAN_TIER_SNR).as<double>();
+  m_tier_area = args.at(PETROSIAN_TIER_AREA).as<int>();
+  if (m_tier_snr < 0 || m_tier_area < 0) {
+    throw Elements::Exception() << "Invalid Petrosian tier thresholds " << m_tier_snr << " " << m_tier_area;
+  }
+
+  m_max_nsigmas = args.at(PETROSIAN_MAX_NSIGMAS).as<double>();
+  if (m_max_nsigmas <= 0) {
+    throw Elements::Exception() << "Invalid Petrosian maximum extent " << m_max_nsigmas;
+  }
+
+  m_exact_overlap = args.at(PETROSIAN_EXACT_OVERLAP).as<bool>();
+  m_group_tasks = args.at(PETROSIAN_GROUP_TASKS).as<bool>();
+  m_fused_photometry = args.at(PETROSIAN_FUSED_PHOTOMETRY).as<bool>();
+
+  m_band_threads = args.at(PETROSIAN_BAND_THREADS).as<int>();
+  if (m_band_threads < 0) {
+    throw Elements::Exception() << "Invalid number of Petrosian band threads " << m_band_threads;
+  }
+
+  m_block_area = args.at(PETROSIAN_BLOCK_AREA).as<int>();
+  m_block_threads = args.at(PETROSIAN_BLOCK_THREADS).as<int>();
+  if (m_block_area < 0 || m_block_threads < 0) {
+    throw Elements::Exception() << "Invalid Petrosian row blocks " << m_block_area << " " << m_block_threads;
+  }
+
   // This parameter is optional and has no default
   if (args.count(PETROSIAN_CHECKIMAGE)) {
     m_checkimage = args.at(PETROSIAN_CHECKIMAGE).as<std::string>();
@@ -87,6 +209,58 @@ double PetrosianConfig::getMinRadius() const {
   return m_minrad;
 }
 
+const std::vector<double>& PetrosianConfig::getFactors() const {
+  return m_factors;
+}
+
+RadiusSearchMode PetrosianConfig::getSearchMode() const {
+  return m_search_mode;
+}
+
+int PetrosianConfig::getBinningArea() const {
+  return m_binning_area;
+}
+
+int PetrosianConfig::getBinningFactor() const {
+  return m_binning_factor;
+}
+
+double PetrosianConfig::getTierSnr() const {
+  return m_tier_snr;
+}
+
+int PetrosianConfig::getTierArea() const {
+  return m_tier_area;
+}
+
+double PetrosianConfig::getMaxNsigmas() const {
+  return m_max_nsigmas;
+}
+
+bool PetrosianConfig::useExactOverlap() const {
+  return m_exact_overlap;
+}
+
+bool PetrosianConfig::useGroupTasks() const {
+  return m_group_tasks;
+}
+
+bool PetrosianConfig::useFusedPhotometry() const {
+  return m_fused_photometry;
+}
+
+int PetrosianConfig::getBandThreads() const {
+  return m_band_threads;
+}
+
+int PetrosianConfig::getBlockArea() const {
+  return m_block_area;
+}
+
+int PetrosianConfig::getBlockThreads() const {
+  return m_block_threads;
+}
+
 boost::filesystem::path PetrosianConfig::getCheckImagePath() const {
   return m_checkimage;
 }
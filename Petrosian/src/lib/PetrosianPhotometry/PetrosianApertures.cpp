@@ -0,0 +1,36 @@
+/**
+ * @file src/lib/PetrosianPhotometry/PetrosianApertures.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/PetrosianPhotometry/PetrosianApertures.h"
+
+namespace Petrosian {
+
+PetrosianApertures::PetrosianApertures(std::vector<PetrosianPhotometry> apertures)
+  : m_apertures(std::move(apertures)) {
+}
+
+const std::vector<PetrosianPhotometry>& PetrosianApertures::getApertures() const {
+  return m_apertures;
+}
+
+}  // namespace Petrosian
@@ -0,0 +1,68 @@
+/**
+ * @file src/lib/PetrosianPhotometry/PetrosianAperturesArray.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/PetrosianPhotometry/PetrosianAperturesArray.h"
+#include <functional>
+
+namespace Petrosian {
+
+PetrosianAperturesArray::PetrosianAperturesArray(std::vector<PetrosianPhotometry> photometries,
+                                                 std::size_t napertures)
+  : m_photometries(std::move(photometries)), m_napertures(napertures) {
+}
+
+template <typename T, typename Getter>
+Euclid::NdArray::NdArray<T> PetrosianAperturesArray::toNdArray(Getter getter) const {
+  std::vector<T> values;
+  values.reserve(m_photometries.size());
+  for (const auto& photometry : m_photometries) {
+    values.emplace_back(getter(photometry));
+  }
+  std::size_t nframes = m_napertures ? m_photometries.size() / m_napertures : 0;
+  return Euclid::NdArray::NdArray<T>({nframes, m_napertures}, std::move(values));
+}
+
+Euclid::NdArray::NdArray<double> PetrosianAperturesArray::getFluxes() const {
+  return toNdArray<double>(std::mem_fn(&PetrosianPhotometry::getFlux));
+}
+
+Euclid::NdArray::NdArray<double> PetrosianAperturesArray::getFluxErrors() const {
+  return toNdArray<double>(std::mem_fn(&PetrosianPhotometry::getFluxError));
+}
+
+Euclid::NdArray::NdArray<double> PetrosianAperturesArray::getMags() const {
+  return toNdArray<double>(std::mem_fn(&PetrosianPhotometry::getMag));
+}
+
+Euclid::NdArray::NdArray<double> PetrosianAperturesArray::getMagErrors() const {
+  return toNdArray<double>(std::mem_fn(&PetrosianPhotometry::getMagError));
+}
+
+Euclid::NdArray::NdArray<int64_t> PetrosianAperturesArray::getFlags() const {
+  // Note that we need to convert the internal representation to an integer
+  return toNdArray<int64_t>([](const PetrosianPhotometry& photometry) {
+    return SourceXtractor::flags2long(photometry.getFlags());
+  });
+}
+
+}  // namespace Petrosian
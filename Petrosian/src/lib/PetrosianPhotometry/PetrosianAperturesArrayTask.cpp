@@ -0,0 +1,46 @@
+/**
+ * @file src/lib/PetrosianPhotometry/PetrosianAperturesArrayTask.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/PetrosianPhotometry/PetrosianApertures.h"
+#include "Petrosian/PetrosianPhotometry/PetrosianAperturesArray.h"
+#include "Petrosian/PetrosianPhotometry/PetrosianAperturesArrayTask.h"
+
+namespace Petrosian {
+
+PetrosianAperturesArrayTask::PetrosianAperturesArrayTask(const std::vector<unsigned>& images)
+  : m_images(images) {
+}
+
+void PetrosianAperturesArrayTask::computeProperties(SourceXtractor::SourceInterface& source) const {
+  // All frames have the same apertures, so they can be laid one after the other
+  std::vector<PetrosianPhotometry> photometries;
+  std::size_t napertures = 0;
+  for (auto img : m_images) {
+    const auto& apertures = source.getProperty<PetrosianApertures>(img).getApertures();
+    napertures = apertures.size();
+    photometries.insert(photometries.end(), apertures.begin(), apertures.end());
+  }
+  source.setProperty<PetrosianAperturesArray>(std::move(photometries), napertures);
+}
+
+}  // namespace Petrosian
@@ -26,33 +26,51 @@
 namespace Petrosian {
 
 
-PetrosianPhotometryArray::PetrosianPhotometryArray(const std::vector<PetrosianPhotometry>& photometries) {
-  for (auto &p : photometries) {
-    m_fluxes.emplace_back(p.getFlux());
-    m_flux_errors.emplace_back(p.getFluxError());
-    m_mags.emplace_back(p.getMag());
-    m_mag_errors.emplace_back(p.getMagError());
-    m_flags.emplace_back(p.getFlags());
+template <typename T>
+BasicPetrosianPhotometryArray<T>::BasicPetrosianPhotometryArray(const std::vector<PetrosianPhotometry>& photometries)
+  : m_nbands(photometries.size()), m_values(NCOLUMNS * m_nbands), m_flags(m_nbands) {
+  for (std::size_t i = 0; i < m_nbands; ++i) {
+    const auto& p = photometries[i];
+    m_values[FLUX * m_nbands + i] = static_cast<T>(p.getFlux());
+    m_values[FLUX_ERROR * m_nbands + i] = static_cast<T>(p.getFluxError());
+    m_values[MAG * m_nbands + i] = static_cast<T>(p.getMag());
+    m_values[MAG_ERROR * m_nbands + i] = static_cast<T>(p.getMagError());
+    m_flags[i] = p.getFlags();
   }
 }
 
-std::vector<double> PetrosianPhotometryArray::getFluxes() const {
-  return m_fluxes;
+template <typename T>
+std::size_t BasicPetrosianPhotometryArray<T>::size() const {
+  return m_nbands;
 }
 
-std::vector<double> PetrosianPhotometryArray::getFluxErrors() const {
-  return m_flux_errors;
+template <typename T>
+ArrayView<T> BasicPetrosianPhotometryArray<T>::getFluxes() const {
+  return m_values.view(FLUX * m_nbands, m_nbands);
 }
 
-std::vector<double> PetrosianPhotometryArray::getMags() const {
-  return m_mags;
+template <typename T>
+ArrayView<T> BasicPetrosianPhotometryArray<T>::getFluxErrors() const {
+  return m_values.view(FLUX_ERROR * m_nbands, m_nbands);
 }
 
-std::vector<double> PetrosianPhotometryArray::getMagErrors() const {
-  return m_mag_errors;
+template <typename T>
+ArrayView<T> BasicPetrosianPhotometryArray<T>::getMags() const {
+  return m_values.view(MAG * m_nbands, m_nbands);
 }
 
-std::vector<SourceXtractor::Flags> PetrosianPhotometryArray::getFlags() const {
-  return m_flags;
+template <typename T>
+ArrayView<T> BasicPetrosianPhotometryArray<T>::getMagErrors() const {
+  return m_values.view(MAG_ERROR * m_nbands, m_nbands);
 }
+
+template <typename T>
+ArrayView<SourceXtractor::Flags> BasicPetrosianPhotometryArray<T>::getFlags() const {
+  return m_flags.view(0, m_nbands);
+}
+
+// Only these two can be used, so the implementation can stay here
+template class BasicPetrosianPhotometryArray<double>;
+template class BasicPetrosianPhotometryArray<float>;
+
 }  // namespace Petrosian
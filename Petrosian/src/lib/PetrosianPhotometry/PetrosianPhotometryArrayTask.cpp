@@ -27,6 +27,9 @@
 
 namespace Petrosian {
 
+// Each thread reuses its own buffer, so there is no allocation once it is big enough
+static thread_local std::vector<PetrosianPhotometry> s_photometries;
+
 PetrosianPhotometryArrayTask::PetrosianPhotometryArrayTask(const std::vector<unsigned>& images)
   : m_images(images) {
 }
@@ -34,7 +37,8 @@ PetrosianPhotometryArrayTask::PetrosianPhotometryArrayTask(const std::vector<uns
 void PetrosianPhotometryArrayTask::computeProperties(SourceXtractor::SourceInterface& source) const {
   // This task is fairly straight-forward: we just iterate over the set of measurement images,
   // obtain the photometry on each one for this source, and group them
-  std::vector<PetrosianPhotometry> photometries;
+  auto& photometries = s_photometries;
+  photometries.clear();
   for (auto img : m_images) {
     photometries.emplace_back(source.getProperty<PetrosianPhotometry>(img));
   }
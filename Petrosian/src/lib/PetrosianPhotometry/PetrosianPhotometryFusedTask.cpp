@@ -0,0 +1,158 @@
+/**
+ * @file src/lib/PetrosianPhotometry/PetrosianPhotometryFusedTask.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include "Petrosian/PetrosianPhotometry/PetrosianPhotometryFusedTask.h"
+#include "Petrosian/PetrosianPhotometry/PetrosianApertures.h"
+#include "Petrosian/PetrosianPhotometry/PetrosianPhotometryArray.h"
+#include "Petrosian/Common/GlobalLock.h"
+#include "Petrosian/Common/TaskStatistics.h"
+
+#include <SEImplementation/Plugin/MeasurementFrame/MeasurementFrame.h>
+
+namespace Petrosian {
+
+namespace {
+
+/**
+ * Everything needed to measure one frame
+ */
+struct BandMeasurement {
+  std::shared_ptr<SourceXtractor::MeasurementImageFrame> m_frame;
+  PhotometryAperture m_aperture;
+  /// The frame does not cover the source, so there is nothing to copy nor measure
+  bool m_outside;
+  ImageStamp m_stamp;
+  SourceXtractor::SeFloat m_variance_threshold;
+  double m_gain;
+  PetrosianPhotometry m_photometry{0., 0., 0., 0., SourceXtractor::Flags::NONE};
+  /// Additional apertures, if any
+  std::vector<PetrosianPhotometry> m_apertures;
+};
+
+}  // namespace
+
+// Each thread reuses its own buffers, so there is no allocation once they are big enough
+static thread_local std::vector<BandMeasurement> s_bands;
+static thread_local std::vector<PetrosianPhotometry> s_photometries;
+
+PetrosianPhotometryFusedTask::PetrosianPhotometryFusedTask(const std::vector<unsigned>& images,
+                                                           const std::vector<FrameSize>& frame_sizes,
+                                                           double mag_zeropoint, bool use_symmetry,
+                                                           bool exact_overlap, const std::vector<double>& factors,
+                                                           double minrad,
+                                                           const boost::filesystem::path& checkimage,
+                                                           std::shared_ptr<ThreadPool> pool,
+                                                           const RowBlocks& blocks)
+  : m_images(images), m_pool(std::move(pool)) {
+  for (size_t i = 0; i < m_images.size(); ++i) {
+    m_measurements.emplace_back(m_images[i], frame_sizes[i], mag_zeropoint, use_symmetry, exact_overlap,
+                                factors, minrad, checkimage, blocks);
+  }
+}
+
+void PetrosianPhotometryFusedTask::computeProperties(SourceXtractor::SourceInterface& source) const {
+  auto& bands = s_bands;
+  if (bands.size() < m_images.size()) {
+    bands.resize(m_images.size());
+  }
+
+  // The Petrosian ellipse is the same for all frames, only its projection changes
+  auto shape = PhotometryMeasurement::getShape(source);
+  bool any_inside = false;
+  for (size_t i = 0; i < m_images.size(); ++i) {
+    auto& band = bands[i];
+    band.m_aperture = m_measurements[i].getAperture(source, shape);
+    band.m_outside = m_measurements[i].isOutside(band.m_aperture);
+    if (!band.m_outside) {
+      band.m_frame = source.getProperty<SourceXtractor::MeasurementFrame>(m_images[i]).getFrame();
+      any_inside = true;
+    }
+  }
+
+  // The whole source is recorded as a single run
+  TaskCost cost{0, 0, 0, 0};
+  if (any_inside) {
+    // The stamps of all frames are copied acquiring the lock only once
+    GlobalLock lock;
+    cost.m_lock_wait = lock.getWaitTime();
+    for (size_t i = 0; i < m_images.size(); ++i) {
+      auto& band = bands[i];
+      if (band.m_outside) {
+        continue;
+      }
+      band.m_variance_threshold = band.m_frame->getVarianceThreshold();
+      band.m_gain = band.m_frame->getGain();
+      band.m_stamp.copy(band.m_frame->getSubtractedImage(), band.m_frame->getVarianceMap(),
+                        band.m_aperture.m_min_pixel, band.m_aperture.m_max_pixel);
+      cost.m_pixels += static_cast<uint64_t>(band.m_stamp.getWidth()) * band.m_stamp.getHeight();
+    }
+  }
+
+  // The measurement itself only touches the stamps, so frames can be done in parallel
+  auto measure_band = [this, &bands](size_t i) {
+    auto& band = bands[i];
+    if (band.m_outside) {
+      band.m_photometry = m_measurements[i].computeOutside(band.m_apertures);
+    }
+    else if (m_measurements[i].hasApertures()) {
+      band.m_photometry = m_measurements[i].compute(band.m_aperture, band.m_stamp, band.m_variance_threshold,
+                                                    band.m_gain, band.m_apertures);
+    }
+    else {
+      band.m_photometry = m_measurements[i].compute(band.m_aperture, band.m_stamp, band.m_variance_threshold,
+                                                    band.m_gain);
+    }
+  };
+  Stopwatch stopwatch;
+  if (m_pool) {
+    m_pool->parallelFor(m_images.size(), measure_band);
+  }
+  else {
+    for (size_t i = 0; i < m_images.size(); ++i) {
+      measure_band(i);
+    }
+  }
+  cost.m_compute = stopwatch.elapsed();
+  TaskStatistics::record(TaskStatistics::PHOTOMETRY, cost);
+
+  // Back on this thread, set the properties
+  auto& photometries = s_photometries;
+  photometries.clear();
+  for (size_t i = 0; i < m_images.size(); ++i) {
+    auto& band = bands[i];
+    source.setIndexedProperty<PetrosianPhotometry>(m_images[i], band.m_photometry);
+    if (m_measurements[i].hasApertures()) {
+      source.setIndexedProperty<PetrosianApertures>(m_images[i], band.m_apertures);
+    }
+    if (!band.m_outside) {
+      m_measurements[i].fillCheckImage(source, band.m_aperture, band.m_stamp);
+    }
+    photometries.emplace_back(band.m_photometry);
+    // Do not keep the frame alive
+    band.m_frame.reset();
+  }
+  source.setProperty<PetrosianPhotometryArray>(photometries);
+}
+
+}  // namespace Petrosian
@@ -0,0 +1,117 @@
+/**
+ * @file src/lib/PetrosianPhotometry/PetrosianPhotometryGroupTask.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include "Petrosian/PetrosianPhotometry/PetrosianPhotometryGroupTask.h"
+#include "Petrosian/Common/GlobalLock.h"
+#include "Petrosian/Common/GroupStamps.h"
+#include "Petrosian/Common/TaskStatistics.h"
+
+#include <SEImplementation/Plugin/MeasurementFrame/MeasurementFrame.h>
+
+#include <vector>
+
+namespace Petrosian {
+
+// Each thread reuses its own buffers, so there is no allocation once they are big enough
+static thread_local std::vector<PhotometryAperture> s_apertures;
+static thread_local GroupStamps s_stamps;
+static thread_local std::vector<bool> s_needs_stamp;
+
+PetrosianPhotometryGroupTask::PetrosianPhotometryGroupTask(unsigned instance, const FrameSize& frame_size,
+                                                           double mag_zeropoint,
+                                                           bool use_symmetry, bool exact_overlap,
+                                                           const std::vector<double>& factors, double minrad,
+                                                           const boost::filesystem::path& checkimage,
+                                                           const RowBlocks& blocks)
+  : m_instance(instance),
+    m_measurement(instance, frame_size, mag_zeropoint, use_symmetry, exact_overlap, factors, minrad,
+                  checkimage, blocks) {
+}
+
+void PetrosianPhotometryGroupTask::computeProperties(SourceXtractor::SourceGroupInterface& group) const {
+  // Project the aperture of every member into this frame, and register the region each one needs
+  auto& apertures = s_apertures;
+  auto& stamps = s_stamps;
+  auto& needs_stamp = s_needs_stamp;
+  apertures.clear();
+  stamps.clear();
+  needs_stamp.clear();
+  std::shared_ptr<SourceXtractor::MeasurementImageFrame> measurement_frame;
+  for (auto& source : group) {
+    auto aperture = m_measurement.getAperture(source);
+    needs_stamp.emplace_back(false);
+
+    // Members that fall off the frame do not need any pixel
+    if (m_measurement.isOutside(aperture)) {
+      m_measurement.measureOutside(source);
+      continue;
+    }
+
+    // All members are measured on the same frame
+    if (!measurement_frame) {
+      measurement_frame = source.getProperty<SourceXtractor::MeasurementFrame>(m_instance).getFrame();
+    }
+
+    apertures.emplace_back(aperture);
+    stamps.add(aperture.m_min_pixel, aperture.m_max_pixel);
+    needs_stamp.back() = true;
+  }
+  if (apertures.empty()) {
+    return;
+  }
+
+  SourceXtractor::SeFloat variance_threshold;
+  double gain;
+  uint64_t lock_wait;
+  {
+    // The pixels of the whole group are copied holding the lock only once
+    GlobalLock lock;
+    lock_wait = lock.getWaitTime();
+
+    const auto& measurement_image = measurement_frame->getSubtractedImage();
+    const auto& variance_map = measurement_frame->getVarianceMap();
+    variance_threshold = measurement_frame->getVarianceThreshold();
+    gain = measurement_frame->getGain();
+
+    stamps.copy(measurement_image, variance_map);
+  }
+
+  // The group is iterated in the same order as before, so the apertures and stamps follow
+  // the members that need them. The wait for the lock is shared evenly by them
+  size_t i = 0, stamp_index = 0;
+  for (auto& source : group) {
+    if (needs_stamp[i]) {
+      const auto& stamp = stamps.getStamp(stamp_index);
+      Stopwatch stopwatch;
+      m_measurement.measure(source, apertures[stamp_index], stamp, variance_threshold, gain);
+      TaskStatistics::record(TaskStatistics::PHOTOMETRY,
+                             {lock_wait / apertures.size(), stopwatch.elapsed(),
+                              static_cast<uint64_t>(stamp.getWidth()) * stamp.getHeight(), 0});
+      ++stamp_index;
+    }
+    ++i;
+  }
+}
+
+}  // namespace Petrosian
@@ -22,103 +22,68 @@
  */
 
 #include "Petrosian/PetrosianPhotometry/PetrosianPhotometryTask.h"
-#include "Petrosian/PetrosianRadius/PetrosianRadius.h"
-#include "Petrosian/PetrosianPhotometry/PetrosianPhotometry.h"
+#include "Petrosian/Common/GlobalLock.h"
+#include "Petrosian/Common/TaskStatistics.h"
 
-#include <limits>
-
-#include <SEFramework/Aperture/FluxMeasurement.h>
-#include <SEFramework/Aperture/EllipticalAperture.h>
-#include <SEFramework/Aperture/TransformedAperture.h>
-
-#include <SEImplementation/Measurement/MultithreadedMeasurement.h>
-#include <SEImplementation/Property/SourceId.h>
 #include <SEImplementation/Plugin/MeasurementFrame/MeasurementFrame.h>
-#include <SEImplementation/Plugin/MeasurementFramePixelCentroid/MeasurementFramePixelCentroid.h>
-#include <SEImplementation/Plugin/ShapeParameters/ShapeParameters.h>
-#include <SEImplementation/Plugin/Jacobian/Jacobian.h>
-#include <SEImplementation/CheckImages/CheckImages.h>
 
 
 namespace Petrosian {
 
-PetrosianPhotometryTask::PetrosianPhotometryTask(unsigned instance, double mag_zeropoint, bool use_symmetry,
-                                                 const boost::filesystem::path& checkimage)
-  : m_instance(instance), m_mag_zeropoint(mag_zeropoint), m_use_symmetry(use_symmetry),
-    m_checkimage(checkimage) {
+// Each thread reuses its own stamp, so there is no allocation once it is big enough
+static thread_local ImageStamp s_stamp;
+
+PetrosianPhotometryTask::PetrosianPhotometryTask(unsigned instance, const FrameSize& frame_size,
+                                                 double mag_zeropoint, bool use_symmetry,
+                                                 bool exact_overlap, const std::vector<double>& factors,
+                                                 double minrad, const boost::filesystem::path& checkimage,
+                                                 const RowBlocks& blocks)
+  : m_instance(instance),
+    m_measurement(instance, frame_size, mag_zeropoint, use_symmetry, exact_overlap, factors, minrad,
+                  checkimage, blocks) {
 }
 
 void PetrosianPhotometryTask::computeProperties(SourceXtractor::SourceInterface& source) const {
-  // When accessing directly the underlying image, we need to make sure no one else is
-  // If this plugin only used other properties - including stamps -, then it would not need to do this
-  std::lock_guard<std::recursive_mutex> lock(SourceXtractor::MultithreadedMeasurement::g_global_mutex);
+  // Project the Petrosian aperture, computed on the detection frame, into this frame
+  auto aperture = m_measurement.getAperture(source);
+
+  // When there are many overlapping frames, most of them do not cover a given source.
+  // There is no need to touch the pixels - nor to lock - for those
+  if (m_measurement.isOutside(aperture)) {
+    m_measurement.measureOutside(source);
+    return;
+  }
 
   // We compute the photometry on the measurement frames.
   // A frame comprises the image, but also its variance map, threshold, coordinate system...
   // Note that the measurement frame is, itself, a property
   const auto& measurement_frame = source.getProperty<SourceXtractor::MeasurementFrame>(m_instance).getFrame();
 
-  // Get, from the frame, the detection image, variance map, threshold, and already thresholded image
-  const auto& measurement_image = measurement_frame->getSubtractedImage();
-  const auto& variance_map = measurement_frame->getVarianceMap();
-  const auto& variance_threshold = measurement_frame->getVarianceThreshold();
-  const auto& threshold_image = measurement_frame->getThresholdedImage();
-  double gain = measurement_frame->getGain();
-
-  // Get the pixel centroid for the source on this frame.
-  auto& centroid = source.getProperty<SourceXtractor::MeasurementFramePixelCentroid>(m_instance);
-  const auto& centroid_x = centroid.getCentroidX();
-  const auto& centroid_y = centroid.getCentroidY();
-
-  // Similarly, get the shape parameters.
-  // This property is computed on the detection frame!
-  auto& shape = source.getProperty<SourceXtractor::ShapeParameters>();
-  const auto& cxx = shape.getEllipseCxx();
-  const auto& cyy = shape.getEllipseCyy();
-  const auto& cxy = shape.getEllipseCxy();
-
-  // We get the Jacobian that allows to transform coordinates between the measurement and the
-  // detection frames
-  const auto& jacobian = source.getProperty<SourceXtractor::JacobianSource>(m_instance);
-
-  // Get the Petrosian radius, also a detection-frame property
-  double petrosian_radius = source.getProperty<PetrosianRadius>().getRadius();
-
-  // Here we create a *transformed* elliptical aperture. This will project the aperture
-  // computed on the detection frame into the measurement frame
-  auto ell_aper = std::make_shared<SourceXtractor::TransformedAperture>(
-    std::make_shared<SourceXtractor::EllipticalAperture>(cxx, cyy, cxy, petrosian_radius),
-    jacobian.asTuple());
-
-  // We do not need to iterate anymore pixel per pixel, and we can rely on this utility
-  auto measurement = SourceXtractor::measureFlux(
-    ell_aper, centroid_x, centroid_y, measurement_image, variance_map, variance_threshold,
-    m_use_symmetry);
-
-  // Compute the derived quantities, as error and magnitude
-  auto flux_error = sqrt(measurement.m_variance + measurement.m_flux / gain);
-  auto mag = measurement.m_flux > 0.0 ? -2.5 * log10(measurement.m_flux) + m_mag_zeropoint
-                                      : std::numeric_limits<double>::quiet_NaN();
-  auto mag_error = 1.0857 * flux_error / measurement.m_flux;
-
-  // Set the source properties
-  source.setIndexedProperty<PetrosianPhotometry>(
-    m_instance, measurement.m_flux, flux_error, mag, mag_error, measurement.m_flags);
-
-  // If configured, write the aperture into the check image for this frame
-  if (!m_checkimage.empty()) {
-    // We rebuild the final path, appending the instance number, and suppressing the extension, as
-    // it is added back by getWriteableCheckImage
-    auto path = m_checkimage.parent_path();
-    auto filename = m_checkimage.stem();
-    filename += "_" + std::to_string(m_instance);
-
-    auto img = SourceXtractor::CheckImages::getInstance().getWriteableCheckImage(
-      (path / filename).native(), measurement_image->getWidth(), measurement_image->getHeight()
-    );
-    auto source_id = source.getProperty<SourceXtractor::SourceId>().getSourceId();
-    SourceXtractor::fillAperture(ell_aper, centroid_x, centroid_y, img, static_cast<float>(source_id));
+  auto& stamp = s_stamp;
+  SourceXtractor::SeFloat variance_threshold;
+  double gain;
+  uint64_t lock_wait;
+  {
+    // When accessing directly the underlying image, we need to make sure no one else is
+    // If this plugin only used other properties - including stamps -, then it would not need to do this
+    // We only hold the lock while copying the pixels we need, so other threads can keep going
+    GlobalLock lock;
+    lock_wait = lock.getWaitTime();
+
+    // Get, from the frame, the measurement image, variance map, threshold and gain
+    const auto& measurement_image = measurement_frame->getSubtractedImage();
+    const auto& variance_map = measurement_frame->getVarianceMap();
+    variance_threshold = measurement_frame->getVarianceThreshold();
+    gain = measurement_frame->getGain();
+
+    stamp.copy(measurement_image, variance_map, aperture.m_min_pixel, aperture.m_max_pixel);
   }
+
+  // Measure, and set the source properties
+  Stopwatch stopwatch;
+  m_measurement.measure(source, aperture, stamp, variance_threshold, gain);
+  uint64_t pixels = static_cast<uint64_t>(stamp.getWidth()) * stamp.getHeight();
+  TaskStatistics::record(TaskStatistics::PHOTOMETRY, {lock_wait, stopwatch.elapsed(), pixels, 0});
 }
 
 }  // namespace Petrosian
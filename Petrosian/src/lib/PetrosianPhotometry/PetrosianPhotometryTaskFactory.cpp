@@ -22,11 +22,16 @@
  */
 
 #include "Petrosian/PetrosianConfig.h"
+#include "Petrosian/PetrosianPhotometry/PetrosianApertures.h"
+#include "Petrosian/PetrosianPhotometry/PetrosianAperturesArray.h"
+#include "Petrosian/PetrosianPhotometry/PetrosianAperturesArrayTask.h"
 #include "Petrosian/PetrosianPhotometry/PetrosianPhotometry.h"
+#include "Petrosian/PetrosianPhotometry/PetrosianPhotometryGroupTask.h"
 #include "Petrosian/PetrosianPhotometry/PetrosianPhotometryTask.h"
 #include "Petrosian/PetrosianPhotometry/PetrosianPhotometryTaskFactory.h"
 #include "Petrosian/PetrosianPhotometry/PetrosianPhotometryArray.h"
 #include "Petrosian/PetrosianPhotometry/PetrosianPhotometryArrayTask.h"
+#include "Petrosian/PetrosianPhotometry/PetrosianPhotometryFusedTask.h"
 
 #include <SEImplementation/Configuration/MagnitudeConfig.h>
 #include <SEImplementation/Configuration/MeasurementImageConfig.h>
@@ -41,23 +46,47 @@ PetrosianPhotometryTaskFactory::createTask(const SourceXtractor::PropertyId& pro
   // ------------------------------------------------------------------------
   // This task factory takes care of the creation of tasks for two different
   // properties:
-  //  PetrosianPhotometry and PetrosianPhotometryArray
+  //  PetrosianPhotometry and PetrosianPhotometryArray,
+  //  and their counterparts for the additional apertures
   // We switch based on the getTypeId()
   // ------------------------------------------------------------------------
 
   // Photometry of a source on a single image
-  if (property_id.getTypeId() == typeid(PetrosianPhotometry)) {
+  // The additional apertures are measured by the same task. If none are configured and they
+  // are requested anyway, they default to the main aperture
+  bool is_photometry = property_id.getTypeId() == typeid(PetrosianPhotometry);
+  bool is_apertures = property_id.getTypeId() == typeid(PetrosianApertures);
+  if (is_photometry || is_apertures) {
+    const auto& factors = (is_apertures && m_factors.empty()) ? std::vector<double>{m_factor} : m_factors;
+    const auto& frame_size = getFrameSize(property_id.getIndex());
     // Note we use getIndex() to identify the unique frame
     // In effect, a property is a unique combination of type and measurement frame
+    if (m_group_tasks) {
+      return std::make_shared<PetrosianPhotometryGroupTask>(
+        property_id.getIndex(), frame_size, m_magnitude_zero_point, m_use_symmetry, m_exact_overlap,
+        factors, m_minrad, m_checkimage, m_blocks
+      );
+    }
     return std::make_shared<PetrosianPhotometryTask>(
-      property_id.getIndex(), m_magnitude_zero_point, m_use_symmetry,
-      m_checkimage
+      property_id.getIndex(), frame_size, m_magnitude_zero_point, m_use_symmetry, m_exact_overlap,
+      factors, m_minrad, m_checkimage, m_blocks
     );
   }
   // Group photometries
   else if (property_id.getTypeId() == typeid(PetrosianPhotometryArray)) {
+    // All frames can be measured at once, sharing the setup and the lock
+    if (m_fused_photometry) {
+      return std::make_shared<PetrosianPhotometryFusedTask>(
+        m_images, m_frame_sizes, m_magnitude_zero_point, m_use_symmetry, m_exact_overlap, m_factors, m_minrad,
+        m_checkimage, m_band_pool, m_blocks
+      );
+    }
     return std::make_shared<PetrosianPhotometryArrayTask>(m_images);
   }
+  // Additional apertures of all images
+  else if (property_id.getTypeId() == typeid(PetrosianAperturesArray)) {
+    return std::make_shared<PetrosianAperturesArrayTask>(m_images);
+  }
   return nullptr;
 }
 
@@ -75,13 +104,46 @@ void PetrosianPhotometryTaskFactory::configure(Euclid::Configuration::ConfigMana
   m_magnitude_zero_point = manager.getConfiguration<SourceXtractor::MagnitudeConfig>().getMagnitudeZeroPoint();
   m_use_symmetry = manager.getConfiguration<SourceXtractor::WeightImageConfig>().symmetryUsage();
   m_checkimage = manager.getConfiguration<PetrosianConfig>().getCheckImagePath();
+  m_group_tasks = manager.getConfiguration<PetrosianConfig>().useGroupTasks();
+  m_exact_overlap = manager.getConfiguration<PetrosianConfig>().useExactOverlap();
+  m_fused_photometry = manager.getConfiguration<PetrosianConfig>().useFusedPhotometry();
+  m_factor = manager.getConfiguration<PetrosianConfig>().getFactor();
+  m_factors = manager.getConfiguration<PetrosianConfig>().getFactors();
+  m_minrad = manager.getConfiguration<PetrosianConfig>().getMinRadius();
+
+  auto band_threads = manager.getConfiguration<PetrosianConfig>().getBandThreads();
+  if (m_fused_photometry && band_threads > 0) {
+    m_band_pool = std::make_shared<ThreadPool>(band_threads);
+  }
+
+  auto block_area = manager.getConfiguration<PetrosianConfig>().getBlockArea();
+  auto block_threads = manager.getConfiguration<PetrosianConfig>().getBlockThreads();
+  std::shared_ptr<ThreadPool> block_pool;
+  if (block_area > 0 && block_threads > 0) {
+    block_pool = std::make_shared<ThreadPool>(block_threads);
+  }
+  m_blocks = RowBlocks(block_area, block_pool);
 
   const auto& measurement_config = manager.getConfiguration<SourceXtractor::MeasurementImageConfig>();
   const auto& image_infos = measurement_config.getImageInfos();
 
+  // The dimensions of the frames are known beforehand, so the tasks can tell which sources
+  // fall off a frame without accessing it
   for (unsigned i = 0; i < image_infos.size(); ++i) {
     m_images.push_back(image_infos[i].m_id);
+    const auto& image = image_infos[i].m_measurement_image;
+    m_frame_sizes.push_back(image ? FrameSize{image->getWidth(), image->getHeight()} : FrameSize{0, 0});
+  }
+}
+
+FrameSize PetrosianPhotometryTaskFactory::getFrameSize(unsigned image) const {
+  for (size_t i = 0; i < m_images.size(); ++i) {
+    if (m_images[i] == image) {
+      return m_frame_sizes[i];
+    }
   }
+  // Unknown, so every source is measured
+  return {0, 0};
 }
 
 }  // namespace Petrosian
@@ -0,0 +1,279 @@
+/**
+ * @file src/lib/PetrosianPhotometry/PhotometryMeasurement.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include "Petrosian/PetrosianPhotometry/PhotometryMeasurement.h"
+#include "Petrosian/PetrosianPhotometry/PetrosianPhotometry.h"
+#include "Petrosian/PetrosianPhotometry/PetrosianApertures.h"
+#include "Petrosian/PetrosianProfile/PetrosianProfileRadii.h"
+#include "Petrosian/PetrosianRadius/PetrosianRadius.h"
+#include "Petrosian/Common/ApertureFlux.h"
+#include "Petrosian/Common/PixelOverlap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <SEImplementation/Property/SourceId.h>
+#include <SEImplementation/Plugin/MeasurementFramePixelCentroid/MeasurementFramePixelCentroid.h>
+#include <SEImplementation/Plugin/ShapeParameters/ShapeParameters.h>
+#include <SEImplementation/Plugin/Jacobian/Jacobian.h>
+
+namespace Petrosian {
+
+// Each thread reuses its own buffers for the additional apertures, so there is no allocation
+// once they are big enough
+static thread_local std::vector<double> s_radii;
+static thread_local std::vector<size_t> s_order;
+static thread_local std::vector<EllipseAperture> s_ellipses;
+static thread_local std::vector<PixelOverlap> s_overlaps;
+static thread_local std::vector<ApertureFlux> s_fluxes, s_sorted_fluxes;
+
+/**
+ * There is nothing to measure for apertures off the frame
+ */
+static PetrosianPhotometry outsidePhotometry() {
+  auto nan = std::numeric_limits<double>::quiet_NaN();
+  return {nan, nan, nan, nan, SourceXtractor::Flags::OUTSIDE};
+}
+
+/**
+ * Apertures that reach a neighbour are contaminated by its light
+ */
+static void flagNeighbours(ApertureFlux& measurement, const PhotometryAperture& aperture, double radius) {
+  if (radius > aperture.m_neighbour_radius) {
+    measurement.m_flags |= SourceXtractor::Flags::NEIGHBORS;
+  }
+}
+
+/**
+ * Compute the derived quantities, as error and magnitude
+ */
+static PetrosianPhotometry toPhotometry(const ApertureFlux& measurement, double gain, double mag_zeropoint) {
+  if ((measurement.m_flags & SourceXtractor::Flags::OUTSIDE) == SourceXtractor::Flags::OUTSIDE) {
+    return outsidePhotometry();
+  }
+
+  auto flux_error = sqrt(measurement.m_variance + measurement.m_flux / gain);
+  auto mag = measurement.m_flux > 0.0 ? -2.5 * log10(measurement.m_flux) + mag_zeropoint
+                                      : std::numeric_limits<double>::quiet_NaN();
+  auto mag_error = 1.0857 * flux_error / measurement.m_flux;
+
+  return {measurement.m_flux, flux_error, mag, mag_error, measurement.m_flags};
+}
+
+PhotometryMeasurement::PhotometryMeasurement(unsigned instance, const FrameSize& frame_size, double mag_zeropoint,
+                                             bool use_symmetry, bool exact_overlap,
+                                             const std::vector<double>& factors, double minrad,
+                                             const boost::filesystem::path& checkimage, const RowBlocks& blocks)
+  : m_instance(instance), m_frame_size(frame_size), m_mag_zeropoint(mag_zeropoint),
+    m_use_symmetry(use_symmetry), m_exact_overlap(exact_overlap), m_factors(factors), m_minrad(minrad),
+    m_checkimage(checkimage), m_blocks(blocks) {
+  if (!m_checkimage.empty()) {
+    // We rebuild the final path, appending the instance number, and suppressing the extension, as
+    // it is added back by getWriteableCheckImage
+    auto path = m_checkimage.parent_path();
+    auto filename = m_checkimage.stem();
+    filename += "_" + std::to_string(m_instance);
+    m_checkimage_sink = std::make_shared<CheckImageSink>((path / filename).native());
+  }
+}
+
+PhotometryShape PhotometryMeasurement::getShape(SourceXtractor::SourceInterface& source) {
+  // Get the shape parameters.
+  // This property is computed on the detection frame!
+  auto& shape = source.getProperty<SourceXtractor::ShapeParameters>();
+
+  // Get the Petrosian radius, also a detection-frame property
+  const auto& petrosian_radius = source.getProperty<PetrosianRadius>();
+
+  // And the profile it comes from, which knows where the neighbours are
+  const auto& profile = source.getProperty<PetrosianProfileRadii>();
+
+  return {shape.getEllipseCxx(), shape.getEllipseCyy(), shape.getEllipseCxy(),
+          static_cast<SourceXtractor::SeFloat>(petrosian_radius.getRadius()),
+          static_cast<SourceXtractor::SeFloat>(petrosian_radius.getPetrosianRadius()),
+          static_cast<SourceXtractor::SeFloat>(profile.getNeighbourRadius())};
+}
+
+PhotometryAperture PhotometryMeasurement::getAperture(SourceXtractor::SourceInterface& source) const {
+  return getAperture(source, getShape(source));
+}
+
+PhotometryAperture PhotometryMeasurement::getAperture(SourceXtractor::SourceInterface& source,
+                                                      const PhotometryShape& shape) const {
+  // Get the pixel centroid for the source on this frame.
+  auto& centroid = source.getProperty<SourceXtractor::MeasurementFramePixelCentroid>(m_instance);
+  const auto& centroid_x = centroid.getCentroidX();
+  const auto& centroid_y = centroid.getCentroidY();
+
+  // We get the Jacobian that allows to transform coordinates between the measurement and the
+  // detection frames
+  const auto& jacobian = source.getProperty<SourceXtractor::JacobianSource>(m_instance);
+
+  // The aperture is projected into the measurement frame once, so measuring it does not need
+  // to transform every pixel back to the detection frame
+  auto ellipse = EllipseAperture::transform(shape.m_cxx, shape.m_cyy, shape.m_cxy, shape.m_radius,
+                                            jacobian.asTuple(), centroid_x, centroid_y);
+
+  // The transformation does not change the radius, so the additional apertures only need
+  // the biggest one to be covered by the stamp
+  double max_radius = ellipse.getRadius();
+  for (auto factor : m_factors) {
+    max_radius = std::max(max_radius, std::max(shape.m_petrosian_radius * factor, m_minrad));
+  }
+  EllipseAperture outer(ellipse.getCxx(), ellipse.getCyy(), ellipse.getCxy(), max_radius, centroid_x, centroid_y);
+
+  // The stamp covers the bounding box of the aperture, plus a margin of one pixel so
+  // the symmetric of any pixel inside the aperture can be found
+  PhotometryAperture aperture{ellipse.getCxx(), ellipse.getCyy(), ellipse.getCxy(), ellipse.getRadius(),
+                              shape.m_petrosian_radius, shape.m_neighbour_radius, centroid_x, centroid_y,
+                              outer.getMinPixel(), outer.getMaxPixel()};
+  aperture.m_min_pixel.m_x -= 1;
+  aperture.m_min_pixel.m_y -= 1;
+  aperture.m_max_pixel.m_x += 1;
+  aperture.m_max_pixel.m_y += 1;
+
+  return aperture;
+}
+
+PetrosianPhotometry PhotometryMeasurement::compute(const PhotometryAperture& aperture, const ImageStamp& stamp,
+                                                   SourceXtractor::SeFloat variance_threshold, double gain) const {
+  auto ellipse = aperture.getEllipse();
+
+  // We do not need to iterate anymore pixel per pixel, and we can rely on this utility
+  ApertureFlux measurement;
+  if (m_exact_overlap) {
+    // Pixels crossed by the edge of the aperture contribute with the fraction that is inside
+    measurement = measureApertureFlux(ellipse, PixelOverlap(ellipse), stamp, variance_threshold, m_use_symmetry,
+                                      m_blocks);
+  }
+  else {
+    measurement = measureApertureFlux(ellipse, stamp, variance_threshold, m_use_symmetry, m_blocks);
+  }
+  flagNeighbours(measurement, aperture, aperture.m_radius);
+
+  return toPhotometry(measurement, gain, m_mag_zeropoint);
+}
+
+PetrosianPhotometry PhotometryMeasurement::compute(const PhotometryAperture& aperture, const ImageStamp& stamp,
+                                                   SourceXtractor::SeFloat variance_threshold, double gain,
+                                                   std::vector<PetrosianPhotometry>& apertures) const {
+  // The main aperture goes first, followed by the additional ones
+  auto& radii = s_radii;
+  radii.clear();
+  radii.emplace_back(aperture.m_radius);
+  for (auto factor : m_factors) {
+    radii.emplace_back(std::max(aperture.m_petrosian_radius * factor, m_minrad));
+  }
+
+  // The apertures are measured from the innermost outwards
+  auto& order = s_order;
+  order.resize(radii.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&radii](size_t a, size_t b) {
+    return radii[a] < radii[b];
+  });
+
+  auto& ellipses = s_ellipses;
+  ellipses.clear();
+  for (auto i : order) {
+    ellipses.emplace_back(aperture.m_cxx, aperture.m_cyy, aperture.m_cxy, radii[i],
+                          aperture.m_centroid_x, aperture.m_centroid_y);
+  }
+
+  auto& sorted_fluxes = s_sorted_fluxes;
+  if (m_exact_overlap) {
+    auto& overlaps = s_overlaps;
+    overlaps.clear();
+    for (const auto& ellipse : ellipses) {
+      overlaps.emplace_back(ellipse);
+    }
+    measureApertureFluxes(ellipses, overlaps, stamp, variance_threshold, m_use_symmetry, sorted_fluxes, m_blocks);
+  }
+  else {
+    measureApertureFluxes(ellipses, stamp, variance_threshold, m_use_symmetry, sorted_fluxes, m_blocks);
+  }
+
+  // Back to the configured order
+  auto& fluxes = s_fluxes;
+  fluxes.resize(sorted_fluxes.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    fluxes[order[i]] = sorted_fluxes[i];
+    flagNeighbours(fluxes[order[i]], aperture, radii[order[i]]);
+  }
+
+  apertures.clear();
+  for (size_t i = 1; i < fluxes.size(); ++i) {
+    apertures.emplace_back(toPhotometry(fluxes[i], gain, m_mag_zeropoint));
+  }
+  return toPhotometry(fluxes.front(), gain, m_mag_zeropoint);
+}
+
+PetrosianPhotometry PhotometryMeasurement::computeOutside(std::vector<PetrosianPhotometry>& apertures) const {
+  apertures.assign(m_factors.size(), outsidePhotometry());
+  return outsidePhotometry();
+}
+
+void PhotometryMeasurement::measureOutside(SourceXtractor::SourceInterface& source) const {
+  std::vector<PetrosianPhotometry> apertures;
+  source.setIndexedProperty<PetrosianPhotometry>(m_instance, computeOutside(apertures));
+  if (hasApertures()) {
+    source.setIndexedProperty<PetrosianApertures>(m_instance, std::move(apertures));
+  }
+}
+
+void PhotometryMeasurement::fillCheckImage(SourceXtractor::SourceInterface& source,
+                                           const PhotometryAperture& aperture, const ImageStamp& stamp) const {
+  if (!m_checkimage_sink) {
+    return;
+  }
+
+  // The sink takes care of the global lock, and batches the writes of several sources
+  auto source_id = source.getProperty<SourceXtractor::SourceId>().getSourceId();
+  m_checkimage_sink->fillAperture(aperture.getEllipse(), stamp.getImageWidth(), stamp.getImageHeight(),
+                                  static_cast<float>(source_id));
+}
+
+void PhotometryMeasurement::measure(SourceXtractor::SourceInterface& source, const PhotometryAperture& aperture,
+                                    const ImageStamp& stamp, SourceXtractor::SeFloat variance_threshold,
+                                    double gain) const {
+  // Set the source properties
+  if (hasApertures()) {
+    std::vector<PetrosianPhotometry> apertures;
+    source.setIndexedProperty<PetrosianPhotometry>(
+      m_instance, compute(aperture, stamp, variance_threshold, gain, apertures)
+    );
+    source.setIndexedProperty<PetrosianApertures>(m_instance, std::move(apertures));
+  }
+  else {
+    source.setIndexedProperty<PetrosianPhotometry>(m_instance, compute(aperture, stamp, variance_threshold, gain));
+  }
+
+  // If configured, write the aperture into the check image for this frame
+  fillCheckImage(source, aperture, stamp);
+}
+
+}  // namespace Petrosian
@@ -23,22 +23,163 @@
 
 #include "Petrosian/PetrosianPlugin.h"
 #include "Petrosian/PetrosianConfig.h"
+#include "Petrosian/PetrosianProfile/PetrosianProfileRadii.h"
+#include "Petrosian/PetrosianRadius/PetrosianDiagnostics.h"
+#include "Petrosian/PetrosianRadius/PetrosianLightRadii.h"
 #include "Petrosian/PetrosianRadius/PetrosianRadius.h"
 #include "Petrosian/PetrosianRadius/PetrosianRadiusTaskFactory.h"
+#include "Petrosian/PetrosianPhotometry/PetrosianApertures.h"
+#include "Petrosian/PetrosianPhotometry/PetrosianAperturesArray.h"
 #include "Petrosian/PetrosianPhotometry/PetrosianPhotometryArray.h"
 #include "Petrosian/PetrosianPhotometry/PetrosianPhotometryTaskFactory.h"
+#include "Petrosian/Common/GlobalLock.h"
+#include "Petrosian/Common/RowKernel.h"
+#include "Petrosian/Common/TaskStatistics.h"
 #include <boost/dll/alias.hpp>
 
 namespace Petrosian {
 
 static std::string s_pluginName{"PetrosianPlugin"};
 
+static Elements::Logging logger = Elements::Logging::getLogger("PetrosianPlugin");
+
+/**
+ * Register the columns of PetrosianPhotometryArray. The column type follows the type used
+ * to store the values.
+ * @param registry
+ *    The output registry
+ */
+template <typename ArrayType>
+static void registerArrayColumns(SourceXtractor::OutputRegistry& registry) {
+  using ColumnType = std::vector<typename ArrayType::ValueType>;
+
+  // The getters return views, so the values are copied only once, straight into the column
+
+  registry.registerColumnConverter<ArrayType, ColumnType>(
+    "petrosian_flux",
+    [](const ArrayType& prop) {
+      return prop.getFluxes().toVector();
+    },
+    "[count]",
+    "Flux within a Petronian-like elliptical aperture"
+  );
+
+  registry.registerColumnConverter<ArrayType, ColumnType>(
+    "petrosian_flux_err",
+    [](const ArrayType& prop) {
+      return prop.getFluxErrors().toVector();
+    },
+    "[count]",
+    "Flux error within a Petronian-like elliptical aperture"
+  );
+
+  registry.registerColumnConverter<ArrayType, ColumnType>(
+    "petrosian_mag",
+    [](const ArrayType& prop) {
+      return prop.getMags().toVector();
+    },
+    "[count]",
+    "Magnitude within a Petronian-like elliptical aperture"
+  );
+
+  registry.registerColumnConverter<ArrayType, ColumnType>(
+    "petrosian_mag_err",
+    [](const ArrayType& prop) {
+      return prop.getMagErrors().toVector();
+    },
+    "[count]",
+    "Magnitude error within a Petronian-like elliptical aperture"
+  );
+
+  registry.registerColumnConverter<ArrayType, std::vector<int64_t>>(
+    "petrosian_flags",
+    [](const ArrayType& prop) {
+      // Note that we need to convert the internal representation to an integer
+      std::vector<int64_t> flags;
+      flags.reserve(prop.size());
+      for (auto flag : prop.getFlags()) {
+        flags.emplace_back(SourceXtractor::flags2long(flag));
+      }
+      return flags;
+    },
+    "[]",
+    "Flags for the Petrosian photometry"
+  );
+}
+
+/**
+ * Register the columns of PetrosianAperturesArray. Each one is a two dimensional array, with
+ * one row per frame, and one column per aperture.
+ * @param registry
+ *    The output registry
+ */
+static void registerAperturesColumns(SourceXtractor::OutputRegistry& registry) {
+  using ColumnType = Euclid::NdArray::NdArray<double>;
+
+  registry.registerColumnConverter<PetrosianAperturesArray, ColumnType>(
+    "petrosian_aperture_flux",
+    &PetrosianAperturesArray::getFluxes,
+    "[count]",
+    "Flux within each additional Petrosian aperture"
+  );
+
+  registry.registerColumnConverter<PetrosianAperturesArray, ColumnType>(
+    "petrosian_aperture_flux_err",
+    &PetrosianAperturesArray::getFluxErrors,
+    "[count]",
+    "Flux error within each additional Petrosian aperture"
+  );
+
+  registry.registerColumnConverter<PetrosianAperturesArray, ColumnType>(
+    "petrosian_aperture_mag",
+    &PetrosianAperturesArray::getMags,
+    "[count]",
+    "Magnitude within each additional Petrosian aperture"
+  );
+
+  registry.registerColumnConverter<PetrosianAperturesArray, ColumnType>(
+    "petrosian_aperture_mag_err",
+    &PetrosianAperturesArray::getMagErrors,
+    "[count]",
+    "Magnitude error within each additional Petrosian aperture"
+  );
+
+  registry.registerColumnConverter<PetrosianAperturesArray, Euclid::NdArray::NdArray<int64_t>>(
+    "petrosian_aperture_flags",
+    &PetrosianAperturesArray::getFlags,
+    "[]",
+    "Flags for each additional Petrosian aperture"
+  );
+}
+
+PetrosianPlugin::~PetrosianPlugin() {
+  // Useful to verify that the tasks are not serialized on the global lock
+  logger.info() << "Global lock acquired " << GlobalLock::getAcquisitions() << " times, "
+                << GlobalLock::getContentions() << " of them contended";
+
+  // And to see where the time goes, so the number of threads can be chosen
+  logger.info() << "Petrosian tasks ran on " << TaskStatistics::getThreadCount() << " threads";
+  for (int i = 0; i < TaskStatistics::NSTAGES; ++i) {
+    auto stage = static_cast<TaskStatistics::Stage>(i);
+    auto summary = TaskStatistics::summarize(stage);
+    if (summary.m_count == 0) {
+      continue;
+    }
+    logger.info() << "Petrosian " << TaskStatistics::getStageName(stage) << ": " << summary.m_count << " runs, "
+                  << summary.m_total.m_lock_wait * 1e-9 << " s waiting for the lock (p50 < "
+                  << summary.m_lock_wait_p50 * 1e-3 << " us, p99 < " << summary.m_lock_wait_p99 * 1e-3 << " us), "
+                  << summary.m_total.m_compute * 1e-9 << " s computing (p50 < "
+                  << summary.m_compute_p50 * 1e-3 << " us, p99 < " << summary.m_compute_p99 * 1e-3 << " us), "
+                  << summary.m_total.m_pixels << " pixels, " << summary.m_total.m_rings << " rings";
+  }
+}
 
 std::string PetrosianPlugin::getIdString() const {
   return s_pluginName;
 }
 
 void PetrosianPlugin::registerPlugin(SourceXtractor::PluginAPI& plugin_api) {
+  logger.debug() << "Using the " << getRowKernelName() << " implementation of the row kernel";
 
   // ------------------------------------------------------------------------
   // For the Property machinery to works, it needs to know which task factory
@@ -46,16 +187,20 @@ void PetrosianPlugin::registerPlugin(SourceXtractor::PluginAPI& plugin_api) {
   // that.
   // ------------------------------------------------------------------------
 
-  // PetrosianRadiusTaskFactory takes care of the property PetrosianRadius
+  // PetrosianRadiusTaskFactory takes care of the property PetrosianRadius, and of
+  // PetrosianLightRadii and PetrosianDiagnostics, which are computed at the same time. They are
+  // measured from PetrosianProfileRadii, which the same factory knows how to build
   plugin_api.getTaskFactoryRegistry()
-    .registerTaskFactory<PetrosianRadiusTaskFactory, PetrosianRadius>();
+    .registerTaskFactory<PetrosianRadiusTaskFactory, PetrosianRadius, PetrosianLightRadii, PetrosianDiagnostics,
+                         PetrosianProfileRadii>();
 
   // PetrosianPhotometryTaskFactory takes care of both PetrosianPhotometry and
   // PetrosianPhotometryArray
   // Have a look at the documentation of each one of these properties, and at
   // their task, to see why do we have these two, instead of a single one
   plugin_api.getTaskFactoryRegistry()
-    .registerTaskFactory<PetrosianPhotometryTaskFactory, PetrosianPhotometry, PetrosianPhotometryArray>();
+    .registerTaskFactory<PetrosianPhotometryTaskFactory, PetrosianPhotometry, PetrosianPhotometryArray,
+                         PetrosianApertures, PetrosianAperturesArray>();
 
   // ------------------------------------------------------------------------
   // Now that we have set up the factories for the properties, we configure
@@ -66,7 +211,7 @@ void PetrosianPlugin::registerPlugin(SourceXtractor::PluginAPI& plugin_api) {
   // it is consumed by PetrosianPhotometryArray
   // ------------------------------------------------------------------------
 
-  // PetrosianRadius has a single associated column: the radius
+  // PetrosianRadius has two associated columns: the radius, and whether it is only an estimate
 
   plugin_api.getOutputRegistry().registerColumnConverter<PetrosianRadius, double>(
     "petrosian_radius",
@@ -75,57 +220,90 @@ void PetrosianPlugin::registerPlugin(SourceXtractor::PluginAPI& plugin_api) {
     "Petrosian radius"
   );
 
-  // PetrosianPhotometryArray has several columns, which are multidimensional.
-  // This is because SourceXtractor supports multiple measurement images, so you would have one
-  // measurement per image.
-  // If SourceXtractor is run with only a detection image, then there will be one single
-  // elements on the vector, which is transparently exported as a scalar column
+  plugin_api.getOutputRegistry().registerColumnConverter<PetrosianRadius, int64_t>(
+    "petrosian_radius_flags",
+    [](const PetrosianRadius& prop) {
+      return static_cast<int64_t>(prop.getFlags());
+    },
+    "[]",
+    "Flags for the Petrosian radius"
+  );
 
-  plugin_api.getOutputRegistry().registerColumnConverter<PetrosianPhotometryArray, std::vector<double>>(
-    "petrosian_flux",
-    &PetrosianPhotometryArray::getFluxes,
-    "[count]",
-    "Flux within a Petronian-like elliptical aperture"
+  // PetrosianLightRadii has the half and 90% light radii, and their ratio
+
+  plugin_api.getOutputRegistry().registerColumnConverter<PetrosianLightRadii, double>(
+    "petrosian_r50",
+    &PetrosianLightRadii::getR50,
+    "[pixel]",
+    "Radius enclosing 50% of the flux within the Petrosian aperture"
   );
 
-  plugin_api.getOutputRegistry().registerColumnConverter<PetrosianPhotometryArray, std::vector<double>>(
-    "petrosian_flux_err",
-    &PetrosianPhotometryArray::getFluxErrors,
-    "[count]",
-    "Flux error within a Petronian-like elliptical aperture"
+  plugin_api.getOutputRegistry().registerColumnConverter<PetrosianLightRadii, double>(
+    "petrosian_r90",
+    &PetrosianLightRadii::getR90,
+    "[pixel]",
+    "Radius enclosing 90% of the flux within the Petrosian aperture"
   );
 
-  plugin_api.getOutputRegistry().registerColumnConverter<PetrosianPhotometryArray, std::vector<double>>(
-    "petrosian_mag",
-    &PetrosianPhotometryArray::getMags,
-    "[count]",
-    "Magnitude within a Petronian-like elliptical aperture"
+  plugin_api.getOutputRegistry().registerColumnConverter<PetrosianLightRadii, double>(
+    "petrosian_concentration",
+    &PetrosianLightRadii::getConcentration,
+    "[]",
+    "Concentration index, R90 / R50"
   );
 
-  plugin_api.getOutputRegistry().registerColumnConverter<PetrosianPhotometryArray, std::vector<double>>(
-    "petrosian_mag_err",
-    &PetrosianPhotometryArray::getMagErrors,
-    "[count]",
-    "Magnitude error within a Petronian-like elliptical aperture"
+  // PetrosianDiagnostics tells where the time of each source went
+
+  plugin_api.getOutputRegistry().registerColumnConverter<PetrosianDiagnostics, double>(
+    "petrosian_lock_wait",
+    &PetrosianDiagnostics::getLockWait,
+    "[s]",
+    "Time spent waiting for the global lock to measure the Petrosian radius"
   );
 
-  plugin_api.getOutputRegistry().registerColumnConverter<PetrosianPhotometryArray, std::vector<int64_t>>(
-    "petrosian_flags",
-    [](const PetrosianPhotometryArray& prop) {
-      // Note that we need to convert the internal representation to an integer
-      return SourceXtractor::flags2long(prop.getFlags());
-    },
+  plugin_api.getOutputRegistry().registerColumnConverter<PetrosianDiagnostics, double>(
+    "petrosian_compute_time",
+    &PetrosianDiagnostics::getComputeTime,
+    "[s]",
+    "Time spent building the profile and looking for the Petrosian radius"
+  );
+
+  plugin_api.getOutputRegistry().registerColumnConverter<PetrosianDiagnostics, int64_t>(
+    "petrosian_pixels",
+    &PetrosianDiagnostics::getPixels,
     "[]",
-    "Flags for the Petrosian photometry"
+    "Pixels visited to build the Petrosian profile"
   );
 
+  plugin_api.getOutputRegistry().registerColumnConverter<PetrosianDiagnostics, int64_t>(
+    "petrosian_rings",
+    &PetrosianDiagnostics::getRings,
+    "[]",
+    "Rings evaluated to find the Petrosian radius"
+  );
+
+  // PetrosianPhotometryArray has several columns, which are multidimensional.
+  // This is because SourceXtractor supports multiple measurement images, so you would have one
+  // measurement per image.
+  // If SourceXtractor is run with only a detection image, then there will be one single
+  // elements on the vector, which is transparently exported as a scalar column
+
+  registerArrayColumns<PetrosianPhotometryArray>(plugin_api.getOutputRegistry());
+
+  // The additional apertures add one more dimension: one row per frame, and one column per factor
+
+  registerAperturesColumns(plugin_api.getOutputRegistry());
+
   // ------------------------------------------------------------------------
   // Finally, we tell the plugin system how these properties are named. These
   // are the strings to be put in --output-properties, and reported by
   // --list-output-properties
   // ------------------------------------------------------------------------
   plugin_api.getOutputRegistry().enableOutput<PetrosianRadius>("PetrosianRadius");
+  plugin_api.getOutputRegistry().enableOutput<PetrosianLightRadii>("PetrosianLightRadii");
+  plugin_api.getOutputRegistry().enableOutput<PetrosianDiagnostics>("PetrosianDiagnostics");
   plugin_api.getOutputRegistry().enableOutput<PetrosianPhotometryArray>("PetrosianPhotometry");
+  plugin_api.getOutputRegistry().enableOutput<PetrosianAperturesArray>("PetrosianApertures");
 }
 
 /**
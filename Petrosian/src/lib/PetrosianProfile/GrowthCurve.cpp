@@ -0,0 +1,70 @@
+/**
+ * @file src/lib/PetrosianProfile/GrowthCurve.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/PetrosianProfile/GrowthCurve.h"
+
+#include <algorithm>
+
+namespace Petrosian {
+
+GrowthCurve::GrowthCurve(const CumulativeProfile& profile, double inner, const CumulativeProfile* coarse)
+  : m_profile(profile), m_inner(inner), m_coarse(coarse) {
+}
+
+const CumulativeProfile& GrowthCurve::getProfile() const {
+  return m_profile;
+}
+
+double GrowthCurve::getInnerRadius() const {
+  return m_inner;
+}
+
+double GrowthCurve::getMaxRadius() const {
+  return m_coarse ? m_coarse->getMaxRadius() : m_profile.getMaxRadius();
+}
+
+bool GrowthCurve::isFine(double radius) const {
+  return !m_coarse || (radius >= m_inner && radius <= m_profile.getMaxRadius());
+}
+
+double GrowthCurve::getFlux(double radius) const {
+  return isFine(radius) ? m_profile.getFlux(radius) : m_coarse->getFlux(radius);
+}
+
+double GrowthCurve::getRadius(double flux, double max_radius) const {
+  if (!m_coarse) {
+    return m_profile.getRadius(flux, 0., max_radius);
+  }
+  // Before, within, or after the range covered at full resolution
+  if (m_coarse->getFlux(m_inner) >= flux) {
+    return m_coarse->getRadius(flux, 0., std::min(m_inner, max_radius));
+  }
+  double outer = std::min(m_profile.getMaxRadius(), max_radius);
+  if (m_profile.getFlux(outer) >= flux) {
+    return m_profile.getRadius(flux, m_inner, outer);
+  }
+  return m_coarse->getRadius(flux, outer, max_radius);
+}
+
+}  // namespace Petrosian
@@ -0,0 +1,112 @@
+/**
+ * @file src/lib/PetrosianProfile/PetrosianProfileGroupTask.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include "Petrosian/PetrosianProfile/PetrosianProfileGroupTask.h"
+#include "Petrosian/Common/GlobalLock.h"
+#include "Petrosian/Common/GroupStamps.h"
+
+#include <SEFramework/Property/DetectionFrame.h>
+
+#include <vector>
+
+namespace Petrosian {
+
+// Each thread reuses its own buffers, so there is no allocation once they are big enough
+static thread_local std::vector<SourceEllipse> s_ellipses;
+static thread_local std::vector<char> s_faint;
+static thread_local GroupStamps s_stamps;
+
+PetrosianProfileGroupTask::PetrosianProfileGroupTask(double eta, double factor, double minrad,
+                                                     RadiusSearchMode search_mode, int binning_area,
+                                                     int binning_factor, double tier_snr, int tier_area,
+                                                     double max_nsigmas, const RowBlocks& blocks)
+  : m_measurement(eta, factor, minrad, search_mode, binning_area, binning_factor, tier_snr, tier_area, max_nsigmas,
+                  blocks) {}
+
+void PetrosianProfileGroupTask::computeProperties(SourceXtractor::SourceGroupInterface& group) const {
+  // Get the shape of every member, and the region of the detection frame each one needs.
+  // Faint members need none, so they are done right away
+  auto& ellipses = s_ellipses;
+  auto& faint = s_faint;
+  auto& stamps = s_stamps;
+  ellipses.clear();
+  faint.clear();
+  stamps.clear();
+  size_t nprofiled = 0;
+  for (auto& source : group) {
+    ellipses.emplace_back(ProfileMeasurement::getSourceEllipse(source));
+    faint.emplace_back(m_measurement.isFaint(source));
+    if (faint.back()) {
+      m_measurement.measureFaint(source);
+      continue;
+    }
+    auto spans = ProfileMeasurement::getSpans(ellipses.back());
+    stamps.add(spans.getMinPixel(), spans.getMaxPixel());
+    ++nprofiled;
+  }
+  if (nprofiled == 0) {
+    return;
+  }
+
+  // All members are on the same detection frame
+  const auto& detection_frame = (*group.begin()).getProperty<SourceXtractor::DetectionFrame>().getFrame();
+
+  SourceXtractor::SeFloat variance_threshold;
+  uint64_t lock_wait;
+  {
+    // The pixels of the whole group are copied holding the lock only once
+    GlobalLock lock;
+    lock_wait = lock.getWaitTime();
+
+    const auto& detection_image = detection_frame->getSubtractedImage();
+    const auto& detection_variance = detection_frame->getVarianceMap();
+    const auto& threshold_image = detection_frame->getThresholdedImage();
+    variance_threshold = detection_frame->getVarianceThreshold();
+
+    stamps.copy(detection_image, detection_variance, threshold_image);
+  }
+
+  // Members whose profile needs to be extended copy their own bigger stamp
+  auto copy_stamp = [&detection_frame](ImageStamp& extension, const SourceXtractor::PixelCoordinate& min,
+                                       const SourceXtractor::PixelCoordinate& max) {
+    GlobalLock lock;
+    extension.copy(detection_frame->getSubtractedImage(), detection_frame->getVarianceMap(), min, max,
+                   detection_frame->getThresholdedImage());
+    return lock.getWaitTime();
+  };
+
+  // The group is iterated in the same order as before, so the i-th source matches the i-th ellipse,
+  // and the profiled ones the stamps in order
+  // The wait for the lock is shared evenly by all profiled members
+  size_t i = 0, stamp_i = 0;
+  for (auto& source : group) {
+    if (!faint[i]) {
+      m_measurement.measure(source, stamps.getStamp(stamp_i++), ellipses[i], variance_threshold,
+                            lock_wait / nprofiled, copy_stamp);
+    }
+    ++i;
+  }
+}
+
+}  // namespace Petrosian
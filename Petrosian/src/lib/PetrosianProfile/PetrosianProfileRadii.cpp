@@ -0,0 +1,53 @@
+/**
+ * @file src/lib/PetrosianProfile/PetrosianProfileRadii.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/PetrosianProfile/PetrosianProfileRadii.h"
+
+namespace Petrosian {
+
+PetrosianProfileRadii::PetrosianProfileRadii(const RadiusResult& radius, double neighbour_radius)
+  : m_radius(radius), m_neighbour_radius(neighbour_radius), m_cost{0, 0, 0, 0}, m_radius_cost{0, 0, 0, 0} {
+}
+
+const RadiusResult& PetrosianProfileRadii::getRadius() const {
+  return m_radius;
+}
+
+double PetrosianProfileRadii::getNeighbourRadius() const {
+  return m_neighbour_radius;
+}
+
+const TaskCost& PetrosianProfileRadii::getCost() const {
+  return m_cost;
+}
+
+const TaskCost& PetrosianProfileRadii::getRadiusCost() const {
+  return m_radius_cost;
+}
+
+void PetrosianProfileRadii::setCost(const TaskCost& cost, const TaskCost& radius_cost) {
+  m_cost = cost;
+  m_radius_cost = radius_cost;
+}
+
+}  // namespace Petrosian
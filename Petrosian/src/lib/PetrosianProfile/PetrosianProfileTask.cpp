@@ -0,0 +1,93 @@
+/**
+ * @file src/lib/PetrosianProfile/PetrosianProfileTask.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/PetrosianProfile/PetrosianProfileTask.h"
+#include "Petrosian/Common/GlobalLock.h"
+
+#include <SEFramework/Property/DetectionFrame.h>
+
+namespace Petrosian {
+
+// Each thread reuses its own stamp, so there is no allocation once it is big enough
+static thread_local ImageStamp s_stamp;
+
+PetrosianProfileTask::PetrosianProfileTask(double eta, double factor, double minrad, RadiusSearchMode search_mode,
+                                           int binning_area, int binning_factor, double tier_snr, int tier_area,
+                                           double max_nsigmas, const RowBlocks& blocks)
+  : m_measurement(eta, factor, minrad, search_mode, binning_area, binning_factor, tier_snr, tier_area, max_nsigmas,
+                  blocks) {}
+
+void PetrosianProfileTask::computeProperties(SourceXtractor::SourceInterface& source) const {
+  // We compute the profile on the detection frame, so we get it
+  // A frame comprises the image, but also its variance map, threshold, coordinate system...
+  // Note that the detection frame is, itself, a property
+  const auto& detection_frame = source.getProperty<SourceXtractor::DetectionFrame>().getFrame();
+
+  // Get the centroid and shape parameters, and from them the corners of the stamp covered by the aperture
+  auto ellipse = ProfileMeasurement::getSourceEllipse(source);
+
+  // Faint sources do not need the pixels, nor the lock
+  if (m_measurement.isFaint(source)) {
+    m_measurement.measureFaint(source);
+    return;
+  }
+
+  auto spans = ProfileMeasurement::getSpans(ellipse);
+  const auto& min_pixel = spans.getMinPixel();
+  const auto& max_pixel = spans.getMaxPixel();
+
+  auto& stamp = s_stamp;
+  SourceXtractor::SeFloat variance_threshold;
+  uint64_t lock_wait;
+  {
+    // When accessing directly the underlying image, we need to make sure no one else is
+    // If this plugin only used other properties - including stamps -, then it would not need to do this
+    // We only hold the lock while copying the pixels we need, so other threads can keep going
+    GlobalLock lock;
+    lock_wait = lock.getWaitTime();
+
+    // Get, from the frame, the detection image, variance map, threshold, and already thresholded image
+    const auto& detection_image = detection_frame->getSubtractedImage();
+    const auto& detection_variance = detection_frame->getVarianceMap();
+    const auto& threshold_image = detection_frame->getThresholdedImage();
+    variance_threshold = detection_frame->getVarianceThreshold();
+
+    // The thresholded image allows to identify pixels from the stamp that belong
+    // to some other source, so flags can be set appropiately
+    stamp.copy(detection_image, detection_variance, min_pixel, max_pixel, threshold_image);
+  }
+
+  // If the profile needs to be extended, a bigger stamp is copied the same way
+  auto copy_stamp = [&detection_frame](ImageStamp& extension, const SourceXtractor::PixelCoordinate& min,
+                                       const SourceXtractor::PixelCoordinate& max) {
+    GlobalLock lock;
+    extension.copy(detection_frame->getSubtractedImage(), detection_frame->getVarianceMap(), min, max,
+                   detection_frame->getThresholdedImage());
+    return lock.getWaitTime();
+  };
+
+  // Finally set the property
+  m_measurement.measure(source, stamp, ellipse, variance_threshold, lock_wait, copy_stamp);
+}
+
+}  // namespace Petrosian
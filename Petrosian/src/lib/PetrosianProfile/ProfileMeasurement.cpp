@@ -0,0 +1,507 @@
+/**
+ * @file src/lib/PetrosianProfile/ProfileMeasurement.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/PetrosianProfile/ProfileMeasurement.h"
+#include "Petrosian/Common/RowKernel.h"
+#include "Petrosian/Common/StampMask.h"
+
+#include <SEImplementation/Plugin/IsophotalFlux/IsophotalFlux.h>
+#include <SEImplementation/Plugin/PixelCentroid/PixelCentroid.h>
+#include <SEImplementation/Plugin/ShapeParameters/ShapeParameters.h>
+#include <SEImplementation/Property/PixelCoordinateList.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace Petrosian {
+
+static const unsigned PETRO_PROFILE_BINS = 1024;
+// Radius of the first bin of a profile of PETRO_PROFILE_BINS bins up to PETRO_NSIGMAS. Bins are
+// evenly spaced in r^2, so edge k is at sqrt(k) times this
+static const double PETRO_BIN_RADIUS = PETRO_NSIGMAS / std::sqrt(PETRO_PROFILE_BINS);
+
+// A ring spans from kmin to kmax = 1.2 kmin
+static const double PETRO_RING_WIDTH = 1.2;
+
+// When the radius is not found, the profile is extended outwards by this factor at a time
+static const double PETRO_EXTENSION_STEP = 1.5;
+
+namespace {
+
+/**
+ * Working memory for the profile measurement.
+ * There is one per thread, so once it has grown to fit the biggest source seen
+ * no more allocations are needed
+ */
+struct ProfileScratch {
+  std::vector<float> m_row_r2;
+};
+
+/**
+ * Sums of the masked pixels of each block of a binned stamp. They are cumulative along each row
+ * of blocks, so any run of blocks of a row is summed with a difference.
+ * Blocks are aligned on m_min_pixel, and those on the right and bottom edges may be smaller.
+ */
+struct BinnedSums {
+  SourceXtractor::PixelCoordinate m_min_pixel, m_max_pixel;
+  int m_factor, m_nblocks;
+  // m_nblocks + 1 elements per row of blocks, the first one 0
+  std::vector<double> m_flux;
+};
+
+}  // namespace
+
+static thread_local ProfileScratch s_scratch;
+static thread_local StampMask s_mask;
+// Bigger stamp, copied when the profile needs to be extended
+static thread_local ImageStamp s_extension;
+// Profile of each row block of big stamps
+static thread_local std::vector<CumulativeProfile> s_blocks;
+// Full resolution and coarse profiles of the source being measured. Only the radii read from them are kept,
+// so they are reused from source to source
+static thread_local CumulativeProfile s_profile, s_coarse;
+// Block sums of the binned stamp
+static thread_local BinnedSums s_binned;
+
+/**
+ * Mask the pixel at column x with the bits of the mask, which are cleared below the variance threshold
+ * and on neighbours. There is no branch, so loops calling it can be vectorized
+ */
+static inline float maskPixel(const float* values, const MaskRow& usable, int x) {
+  return usable.test(x) ? values[x] : 0.f;
+}
+
+/**
+ * @return The run of whole blocks, of the row of blocks starting at block_y, that are inside the ellipse
+ *    on all their rows
+ */
+static PixelSpan getInnerBlocks(const BinnedSums& binned, const EllipseSpans& spans, int block_y) {
+  int last_y = std::min(block_y + binned.m_factor - 1, binned.m_max_pixel.m_y);
+  if (block_y < spans.getMinY() || last_y > spans.getMaxY()) {
+    return {0, 0};
+  }
+  int x0 = std::numeric_limits<int>::min(), x1 = std::numeric_limits<int>::max();
+  for (int y = block_y; y <= last_y; ++y) {
+    auto span = spans.getSpan(y);
+    x0 = std::max(x0, span.m_x0 - binned.m_min_pixel.m_x);
+    x1 = std::min(x1, span.m_x1 - binned.m_min_pixel.m_x);
+  }
+  if (x1 <= x0) {
+    return {0, 0};
+  }
+  // The last block is whole if it reaches the edge, even if it is smaller
+  int width = binned.m_max_pixel.m_x - binned.m_min_pixel.m_x + 1;
+  return {(x0 + binned.m_factor - 1) / binned.m_factor, x1 >= width ? binned.m_nblocks : x1 / binned.m_factor};
+}
+
+/**
+ * Add to the profile the pixels of the stamp between the ellipses of radius inner (included) and outer.
+ * If inner is greater than 0 and binned is given, the pixels within it are added too, but all together
+ * at the center, since their flux is needed, but not where exactly they are. Otherwise they are skipped.
+ * The blocks of binned that are whole inside the inner ellipse are added from their sums, so of the
+ * pixels within it only those of the blocks crossed by its edge are visited.
+ * Only the rows between min_y and max_y (included) are visited.
+ */
+static void fillAnnulus(CumulativeProfile& profile, const ImageStamp& stamp, const StampMask& mask,
+                        const SourceEllipse& ellipse, double inner, double outer, const BinnedSums* binned,
+                        int min_y, int max_y, ProfileScratch& scratch) {
+  // Rasterize the aperture into row spans, so we only visit pixels that fall inside.
+  // The mask has already been clipped to the stamp, and this to the image, so restricting the
+  // spans to the mask guarantees all visited pixels are valid, without checking them one by one
+  SourceXtractor::PixelCoordinate stamp_min{mask.getMinX(), mask.getMinY()};
+  SourceXtractor::PixelCoordinate stamp_max{mask.getMinX() + mask.getWidth() - 1,
+                                            mask.getMinY() + mask.getHeight() - 1};
+  EllipseSpans outer_spans(ellipse.m_cxx, ellipse.m_cyy, ellipse.m_cxy, outer,
+                           ellipse.m_centroid_x, ellipse.m_centroid_y);
+  EllipseSpans inner_spans(ellipse.m_cxx, ellipse.m_cyy, ellipse.m_cxy, inner,
+                           ellipse.m_centroid_x, ellipse.m_centroid_y);
+  outer_spans.clip(stamp_min, stamp_max);
+  inner_spans.clip(stamp_min, stamp_max);
+
+  // Rows are contiguous in memory, so a whole span is processed at once:
+  // first the radius is computed with a vectorized kernel, and then the pixels are
+  // masked and added to the profile
+  auto& row_r2 = scratch.m_row_r2;
+  row_r2.resize(stamp.getWidth());
+  double inner_flux = 0., inner_area = 0.;
+
+  for (int y = std::max(outer_spans.getMinY(), min_y); y <= std::min(outer_spans.getMaxY(), max_y); ++y) {
+    const auto* values = stamp.getImageRow(y) - stamp.getMinX();
+    auto usable = mask.getUsableRow(y);
+
+    // The terms of the elliptical radius that only depend on the row are computed once
+    float dy = y - ellipse.m_centroid_y;
+    float cxy_dy = ellipse.m_cxy * dy, r2_row = ellipse.m_cyy * dy * dy;
+
+    // The part of the row within the inner ellipse is only accumulated, if at all
+    auto outer_span = outer_spans.getSpan(y);
+    auto inner_span = inner > 0 && y >= inner_spans.getMinY() && y <= inner_spans.getMaxY() ?
+                      inner_spans.getSpan(y) : PixelSpan{outer_span.m_x1, outer_span.m_x1};
+    if (inner_span.empty()) {
+      inner_span = {outer_span.m_x1, outer_span.m_x1};
+    }
+    if (binned && !inner_span.empty()) {
+      // The whole blocks are added once, on their first row, and their pixels skipped on every row
+      int row_offset = (y - binned->m_min_pixel.m_y) % binned->m_factor;
+      int block_y = y - row_offset;
+      auto blocks = getInnerBlocks(*binned, inner_spans, block_y);
+      PixelSpan skipped{inner_span.m_x1, inner_span.m_x1};
+      if (!blocks.empty()) {
+        skipped = {binned->m_min_pixel.m_x + blocks.m_x0 * binned->m_factor,
+                   std::min(binned->m_min_pixel.m_x + blocks.m_x1 * binned->m_factor, binned->m_max_pixel.m_x + 1)};
+        if (row_offset == 0) {
+          size_t row = static_cast<size_t>((block_y - binned->m_min_pixel.m_y) / binned->m_factor) *
+                       (binned->m_nblocks + 1);
+          inner_flux += binned->m_flux[row + blocks.m_x1] - binned->m_flux[row + blocks.m_x0];
+          int block_height = std::min(binned->m_factor, binned->m_max_pixel.m_y - block_y + 1);
+          inner_area += static_cast<double>(skipped.m_x1 - skipped.m_x0) * block_height;
+        }
+      }
+
+      // The pixels of the blocks crossed by the edge, on both sides of the whole ones
+      PixelSpan edges[] = {{inner_span.m_x0, std::min(skipped.m_x0, inner_span.m_x1)},
+                           {std::max(skipped.m_x1, inner_span.m_x0), inner_span.m_x1}};
+      for (const auto& edge : edges) {
+        for (int x = edge.m_x0; x < edge.m_x1; ++x) {
+          inner_flux += maskPixel(values, usable, x);
+        }
+        inner_area += std::max(edge.m_x1 - edge.m_x0, 0);
+      }
+    }
+
+    // Pixels on both sides of the inner ellipse
+    PixelSpan segments[] = {{outer_span.m_x0, inner_span.m_x0}, {inner_span.m_x1, outer_span.m_x1}};
+    for (const auto& segment : segments) {
+      if (segment.empty()) {
+        continue;
+      }
+      int length = segment.m_x1 - segment.m_x0;
+      EllipseRow row{segment.m_x0 - ellipse.m_centroid_x, ellipse.m_cxx, cxy_dy, r2_row};
+      // The pixels are masked with the stamp mask, which knows about neighbours, so only the radius is needed
+      evaluateRowRadius(row, length, row_r2.data());
+      for (int i = 0; i < length; ++i) {
+        profile.add(row_r2[i], maskPixel(values, usable, segment.m_x0 + i));
+      }
+    }
+  }
+
+  if (inner_area > 0) {
+    profile.add(0., inner_flux, inner_area);
+  }
+}
+
+/**
+ * Add the annulus to the profile, as fillAnnulus does. If the mask is big enough, each row block
+ * is filled into its own profile, and they are merged into this one once all are done
+ */
+static void addAnnulus(CumulativeProfile& profile, const ImageStamp& stamp, const StampMask& mask,
+                       const SourceEllipse& ellipse, double inner, double outer, const BinnedSums* binned,
+                       const RowBlocks& blocks) {
+  // Blocks may be filled by other threads, so the scratch is picked by the one that runs it
+  auto fill = [&stamp, &mask, &ellipse, inner, outer, binned](CumulativeProfile& target, int min_y, int max_y) {
+    fillAnnulus(target, stamp, mask, ellipse, inner, outer, binned, min_y, max_y, s_scratch);
+  };
+
+  int min_y = mask.getMinY(), max_y = mask.getMinY() + mask.getHeight() - 1;
+  if (!blocks.applies(mask.getWidth(), mask.getHeight())) {
+    fill(profile, min_y, max_y);
+    return;
+  }
+
+  auto& partials = s_blocks;
+  blocks.reduce(min_y, max_y, partials,
+                [&profile, &fill](CumulativeProfile& partial, int y0, int y1) {
+                  partial.reset(profile);
+                  fill(partial, y0, y1);
+                },
+                [](CumulativeProfile& a, const CumulativeProfile& b) {
+                  a.merge(b);
+                });
+  profile.merge(partials.front());
+}
+
+/**
+ * Apertures beyond the closest neighbour are contaminated, even if its pixels are masked
+ * @return The radius of the closest neighbour pixel on the mask, or infinity if there is none
+ */
+static double getNeighbourRadius(const StampMask& mask, const SourceEllipse& ellipse) {
+  double neighbour_r2 = std::numeric_limits<double>::infinity();
+  mask.forEachNeighbour([&ellipse, &neighbour_r2](int x, int y) {
+    double dx = x - ellipse.m_centroid_x, dy = y - ellipse.m_centroid_y;
+    neighbour_r2 = std::min(neighbour_r2, ellipse.m_cyy * dy * dy + dx * (ellipse.m_cxx * dx + ellipse.m_cxy * dy));
+  });
+  return std::sqrt(neighbour_r2);
+}
+
+/**
+ * Add to the profile the region of the stamp between min_pixel and max_pixel (included), binned by
+ * the given factor. Each block is added as a single element at its center.
+ * The sums of the blocks are kept in binned, so the full resolution pass does not need to visit
+ * the pixels of the blocks it only needs the sum of.
+ */
+static void addBinned(CumulativeProfile& profile, const ImageStamp& stamp, const StampMask& mask,
+                      const SourceEllipse& ellipse, int factor,
+                      const SourceXtractor::PixelCoordinate& min_pixel,
+                      const SourceXtractor::PixelCoordinate& max_pixel, BinnedSums& binned) {
+  int width = max_pixel.m_x - min_pixel.m_x + 1;
+  int nblocks = (width + factor - 1) / factor;
+  int nrows = (max_pixel.m_y - min_pixel.m_y + factor) / factor;
+  binned.m_min_pixel = min_pixel;
+  binned.m_max_pixel = max_pixel;
+  binned.m_factor = factor;
+  binned.m_nblocks = nblocks;
+  binned.m_flux.assign(static_cast<size_t>(std::max(nrows, 0)) * (nblocks + 1), 0.);
+
+  for (int block_y = min_pixel.m_y; block_y <= max_pixel.m_y; block_y += factor) {
+    int block_height = std::min(factor, max_pixel.m_y - block_y + 1);
+
+    // Sum the rows of the band into the blocks. Block b goes into element b + 1 of the row
+    size_t row = static_cast<size_t>((block_y - min_pixel.m_y) / factor) * (nblocks + 1);
+    double* block_flux = binned.m_flux.data() + row + 1;
+    for (int y = block_y; y < block_y + block_height; ++y) {
+      const auto* values = stamp.getImageRow(y) - stamp.getMinX();
+      auto usable = mask.getUsableRow(y);
+      for (int i = 0; i < width; ++i) {
+        block_flux[i / factor] += maskPixel(values, usable, min_pixel.m_x + i);
+      }
+    }
+
+    // And add them at their center
+    float dy = block_y + (block_height - 1) / 2.f - ellipse.m_centroid_y;
+    for (int b = 0; b < nblocks; ++b) {
+      int block_x = min_pixel.m_x + b * factor;
+      int block_width = std::min(factor, max_pixel.m_x - block_x + 1);
+      float dx = block_x + (block_width - 1) / 2.f - ellipse.m_centroid_x;
+      float r2 = ellipse.m_cyy * dy * dy + dx * (ellipse.m_cxx * dx + ellipse.m_cxy * dy);
+      profile.add(r2, block_flux[b], block_width * block_height);
+    }
+
+    // Then make them cumulative along the row
+    for (int b = 1; b < nblocks; ++b) {
+      block_flux[b] += block_flux[b - 1];
+    }
+  }
+}
+
+/**
+ * Clear the profile, giving it the same bins as the full resolution one, but only as many as needed to
+ * reach max_radius. A single bin is extended, as extending keeps the width of the bins
+ */
+static void resetWindow(CumulativeProfile& profile, double max_radius) {
+  profile.reset(PETRO_BIN_RADIUS, 1);
+  profile.extend(max_radius);
+}
+
+ProfileMeasurement::ProfileMeasurement(double eta, double factor, double minrad, RadiusSearchMode search_mode,
+                                       int binning_area, int binning_factor, double tier_snr, int tier_area,
+                                       double max_nsigmas, const RowBlocks& blocks)
+  : m_eta(eta), m_search_mode(search_mode), m_binning_area(binning_area), m_binning_factor(binning_factor),
+    m_tier_snr(tier_snr), m_tier_area(tier_area), m_max_nsigmas(max_nsigmas), m_blocks(blocks),
+    m_radius(eta, factor, minrad, search_mode) {}
+
+SourceEllipse ProfileMeasurement::getSourceEllipse(SourceXtractor::SourceInterface& source) {
+  // Get the pixel centroid for the source. It is another property, computed by a task inside
+  // the main SourceXtractor
+  const auto& centroid = source.getProperty<SourceXtractor::PixelCentroid>();
+
+  // Similarly, get the shape parameters
+  const auto& shape_parameters = source.getProperty<SourceXtractor::ShapeParameters>();
+
+  return {shape_parameters.getEllipseCxx(), shape_parameters.getEllipseCyy(), shape_parameters.getEllipseCxy(),
+          centroid.getCentroidX(), centroid.getCentroidY()};
+}
+
+EllipseSpans ProfileMeasurement::getSpans(const SourceEllipse& ellipse) {
+  // Note that the radius scales the ellipse (so 6 times bigger here)
+  return getSpans(ellipse, PETRO_NSIGMAS);
+}
+
+EllipseSpans ProfileMeasurement::getSpans(const SourceEllipse& ellipse, double radius) {
+  return {ellipse.m_cxx, ellipse.m_cyy, ellipse.m_cxy, radius, ellipse.m_centroid_x, ellipse.m_centroid_y};
+}
+
+bool ProfileMeasurement::isFaint(SourceXtractor::SourceInterface& source) const {
+  if (m_tier_area > 0) {
+    const auto& pixels = source.getProperty<SourceXtractor::PixelCoordinateList>().getCoordinateList();
+    if (pixels.size() < static_cast<size_t>(m_tier_area)) {
+      return true;
+    }
+  }
+  if (m_tier_snr > 0) {
+    // Compared without dividing, as the error may be 0
+    const auto& isophotal = source.getProperty<SourceXtractor::IsophotalFlux>();
+    if (isophotal.getFlux() < m_tier_snr * isophotal.getFluxError()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+PetrosianProfileRadii ProfileMeasurement::compute(const ImageStamp& stamp, const SourceEllipse& ellipse,
+                                             float variance_threshold,
+                                             const std::vector<SourceXtractor::PixelCoordinate>* source_pixels,
+                                             const StampCopier& copy_stamp) const {
+  // The stamp may be shared with other sources, so only the bounding box of this one is considered
+  auto spans = getSpans(ellipse);
+  spans.clip({stamp.getMinX(), stamp.getMinY()},
+             {stamp.getMinX() + stamp.getWidth() - 1, stamp.getMinY() + stamp.getHeight() - 1});
+  auto min_pixel = spans.getMinPixel();
+  auto max_pixel = spans.getMaxPixel();
+  int area = std::max(max_pixel.m_x - min_pixel.m_x + 1, 0) * std::max(max_pixel.m_y - min_pixel.m_y + 1, 0);
+
+  // Which pixels can be used is decided once, and then looked up by every pass over the pixels
+  auto& mask = s_mask;
+  mask.build(stamp, variance_threshold, min_pixel, max_pixel, source_pixels);
+
+  double neighbour_radius = getNeighbourRadius(mask, ellipse);
+
+  // For big sources, first look for the radius on a binned version of the stamp, and then
+  // profile at full resolution only around it
+  auto& profile = s_profile;
+  if (m_binning_area > 0 && area > m_binning_area) {
+    auto& coarse = s_coarse;
+    coarse.reset(PETRO_NSIGMAS, PETRO_PROFILE_BINS);
+    addBinned(coarse, stamp, mask, ellipse, m_binning_factor, min_pixel, max_pixel, s_binned);
+    coarse.accumulate();
+    auto coarse_search = searchPetrosianRadius(coarse, m_eta, m_search_mode);
+
+    if (coarse_search.m_found) {
+      // The bracket must cover the error introduced by the binning (how much the radius can change
+      // within a block), and the quantization of the search itself
+      double margin = 2 * m_binning_factor * std::sqrt(ellipse.m_cxx + ellipse.m_cyy) + PETRO_NSIGMAS / 20.;
+      double coarse_kmin = coarse_search.m_radius / ((1. + PETRO_RING_WIDTH) / 2.);
+      double inner = std::max(coarse_kmin - margin, 0.);
+      double outer = std::min((coarse_kmin + margin) * PETRO_RING_WIDTH, PETRO_NSIGMAS);
+
+      // The window has the same bins as the full resolution profile, and starts and ends on their edges,
+      // so within it the profile is the same as if every pixel had been added.
+      // Below it, only the blocks crossed by its edge are visited, the others are added from their sums
+      inner = PETRO_BIN_RADIUS * std::sqrt(std::floor(inner * inner / (PETRO_BIN_RADIUS * PETRO_BIN_RADIUS)));
+      resetWindow(profile, outer);
+      outer = profile.getMaxRadius();
+      addAnnulus(profile, stamp, mask, ellipse, inner, outer, &s_binned, m_blocks);
+      profile.accumulate();
+
+      // The annulus is only kept if the radius is within. Otherwise, the whole source is
+      // profiled at full resolution
+      if (searchPetrosianRadius(profile, m_eta, m_search_mode, inner).m_found) {
+        return measureRadius(GrowthCurve(profile, inner, &coarse), min_pixel, max_pixel, neighbour_radius);
+      }
+    }
+  }
+
+  // Instead of scanning the stamp once per ring, we histogram every pixel once by its
+  // squared elliptical radius. Any ring can then be measured in constant time from the
+  // cumulative sums
+  profile.reset(PETRO_NSIGMAS, PETRO_PROFILE_BINS);
+  addAnnulus(profile, stamp, mask, ellipse, 0., PETRO_NSIGMAS, nullptr, m_blocks);
+  profile.accumulate();
+
+  // If the radius is not within, a bigger stamp is copied, and only the new outer annulus is added,
+  // until the radius is found or the configured extent is reached. Typical sources never get here
+  double outer = PETRO_NSIGMAS;
+  while (copy_stamp && outer < m_max_nsigmas &&
+         !searchPetrosianRadius(profile, m_eta, m_search_mode).m_found) {
+    profile.extend(std::min(outer * PETRO_EXTENSION_STEP, m_max_nsigmas));
+    double next = profile.getMaxRadius();
+
+    auto extension_spans = getSpans(ellipse, next);
+    copy_stamp(s_extension, extension_spans.getMinPixel(), extension_spans.getMaxPixel());
+    extension_spans.clip({s_extension.getMinX(), s_extension.getMinY()},
+                         {s_extension.getMinX() + s_extension.getWidth() - 1,
+                          s_extension.getMinY() + s_extension.getHeight() - 1});
+    min_pixel = extension_spans.getMinPixel();
+    max_pixel = extension_spans.getMaxPixel();
+
+    mask.build(s_extension, variance_threshold, min_pixel, max_pixel, source_pixels);
+    neighbour_radius = getNeighbourRadius(mask, ellipse);
+    addAnnulus(profile, s_extension, mask, ellipse, outer, next, nullptr, m_blocks);
+    profile.accumulate();
+    outer = next;
+  }
+  return measureRadius(GrowthCurve(profile, 0., nullptr), min_pixel, max_pixel, neighbour_radius);
+}
+
+PetrosianProfileRadii ProfileMeasurement::measureRadius(const GrowthCurve& curve,
+                                                   const SourceXtractor::PixelCoordinate& min_pixel,
+                                                   const SourceXtractor::PixelCoordinate& max_pixel,
+                                                   double neighbour_radius) const {
+  Stopwatch stopwatch;
+  auto radius = m_radius.measure(curve);
+  TaskCost radius_cost{0, stopwatch.elapsed(), 0, radius.m_rings};
+
+  // The pixels visited are those of the bounding box of the source, even if the stamp is shared
+  uint64_t pixels = static_cast<uint64_t>(std::max(max_pixel.m_x - min_pixel.m_x + 1, 0)) *
+                    std::max(max_pixel.m_y - min_pixel.m_y + 1, 0);
+  PetrosianProfileRadii profile(radius, neighbour_radius);
+  profile.setCost({0, 0, pixels, 0}, radius_cost);
+  return profile;
+}
+
+void ProfileMeasurement::measure(SourceXtractor::SourceInterface& source, const ImageStamp& stamp,
+                                 const SourceEllipse& ellipse, float variance_threshold, uint64_t lock_wait,
+                                 const StampCopier& copy_stamp) const {
+  Stopwatch stopwatch;
+
+  // Without the pixels of the source, all those above the threshold would be taken for a neighbour
+  const std::vector<SourceXtractor::PixelCoordinate>* source_pixels = nullptr;
+  if (stamp.hasThresholded()) {
+    source_pixels = &source.getProperty<SourceXtractor::PixelCoordinateList>().getCoordinateList();
+  }
+  // Waiting for the lock when extending is not computing
+  uint64_t extension_wait = 0;
+  StampCopier timed_copy;
+  if (copy_stamp) {
+    timed_copy = [&copy_stamp, &extension_wait](ImageStamp& extension, const SourceXtractor::PixelCoordinate& min,
+                                                const SourceXtractor::PixelCoordinate& max) {
+      uint64_t wait = copy_stamp(extension, min, max);
+      extension_wait += wait;
+      return wait;
+    };
+  }
+  auto profile = compute(stamp, ellipse, variance_threshold, source_pixels, timed_copy);
+
+  // Reading the radii is recorded apart, by PetrosianRadiusTask
+  const auto& radius_cost = profile.getRadiusCost();
+  TaskCost cost{lock_wait + extension_wait, stopwatch.elapsed() - extension_wait - radius_cost.m_compute,
+                profile.getCost().m_pixels, 0};
+  TaskStatistics::record(TaskStatistics::PROFILE, cost);
+
+  profile.setCost(cost, radius_cost);
+  source.setProperty<PetrosianProfileRadii>(std::move(profile));
+}
+
+void ProfileMeasurement::measureFaint(SourceXtractor::SourceInterface& source) const {
+  // It is recorded anyway, so the summary tells how many sources have not been profiled
+  TaskCost cost{0, 0, 0, 0};
+  TaskStatistics::record(TaskStatistics::PROFILE, cost);
+
+  PetrosianProfileRadii profile(m_radius.estimate(), std::numeric_limits<double>::infinity());
+  profile.setCost(cost, cost);
+  source.setProperty<PetrosianProfileRadii>(std::move(profile));
+}
+
+}  // namespace Petrosian
@@ -0,0 +1,48 @@
+/**
+ * @file src/lib/PetrosianRadius/PetrosianDiagnostics.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/PetrosianRadius/PetrosianDiagnostics.h"
+
+namespace Petrosian {
+
+PetrosianDiagnostics::PetrosianDiagnostics(const TaskCost& profile_cost, const TaskCost& radius_cost)
+  : m_profile_cost(profile_cost), m_radius_cost(radius_cost) {
+}
+
+double PetrosianDiagnostics::getLockWait() const {
+  return (m_profile_cost.m_lock_wait + m_radius_cost.m_lock_wait) * 1e-9;
+}
+
+double PetrosianDiagnostics::getComputeTime() const {
+  return (m_profile_cost.m_compute + m_radius_cost.m_compute) * 1e-9;
+}
+
+int64_t PetrosianDiagnostics::getPixels() const {
+  return m_profile_cost.m_pixels + m_radius_cost.m_pixels;
+}
+
+int64_t PetrosianDiagnostics::getRings() const {
+  return m_profile_cost.m_rings + m_radius_cost.m_rings;
+}
+
+}  // namespace Petrosian
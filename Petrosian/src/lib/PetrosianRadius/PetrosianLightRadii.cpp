@@ -0,0 +1,45 @@
+/**
+ * @file src/lib/PetrosianRadius/PetrosianLightRadii.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/PetrosianRadius/PetrosianLightRadii.h"
+
+namespace Petrosian {
+
+PetrosianLightRadii::PetrosianLightRadii(double r50, double r90)
+  : m_r50(r50), m_r90(r90) {
+}
+
+double PetrosianLightRadii::getR50() const {
+  return m_r50;
+}
+
+double PetrosianLightRadii::getR90() const {
+  return m_r90;
+}
+
+double PetrosianLightRadii::getConcentration() const {
+  // NaN if any of them is not defined
+  return m_r90 / m_r50;
+}
+
+}  // namespace Petrosian
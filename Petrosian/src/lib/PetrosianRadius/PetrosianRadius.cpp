@@ -25,14 +25,22 @@
 
 namespace Petrosian {
 
-PetrosianRadius::PetrosianRadius(double radius)
-  : m_radius(radius) {
+PetrosianRadius::PetrosianRadius(double radius, double petrosian_radius, RadiusFlags flags)
+  : m_radius(radius), m_petrosian_radius(petrosian_radius), m_flags(flags) {
 }
 
 double PetrosianRadius::getRadius() const {
   return m_radius;
 }
 
+double PetrosianRadius::getPetrosianRadius() const {
+  return m_petrosian_radius;
+}
+
+RadiusFlags PetrosianRadius::getFlags() const {
+  return m_flags;
+}
+
 }  // namespace Petrosian
 
 
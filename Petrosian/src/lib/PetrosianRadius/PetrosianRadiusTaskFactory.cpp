@@ -22,6 +22,11 @@
  */
 
 #include "Petrosian/PetrosianConfig.h"
+#include "Petrosian/PetrosianProfile/PetrosianProfileRadii.h"
+#include "Petrosian/PetrosianProfile/PetrosianProfileGroupTask.h"
+#include "Petrosian/PetrosianProfile/PetrosianProfileTask.h"
+#include "Petrosian/PetrosianRadius/PetrosianDiagnostics.h"
+#include "Petrosian/PetrosianRadius/PetrosianLightRadii.h"
 #include "Petrosian/PetrosianRadius/PetrosianRadius.h"
 #include "Petrosian/PetrosianRadius/PetrosianRadiusTask.h"
 #include "Petrosian/PetrosianRadius/PetrosianRadiusTaskFactory.h"
@@ -31,10 +36,25 @@ namespace Petrosian {
 
 std::shared_ptr<SourceXtractor::Task>
 PetrosianRadiusTaskFactory::createTask(const SourceXtractor::PropertyId& property_id) const {
-  // This task factory only knows how to create a task that computes the PetrosianRadius
-  // Note that this function will normally be called if it is not for that property, but it is good to check
-  if (property_id.getTypeId() == typeid(PetrosianRadius)) {
-    return std::make_shared<PetrosianRadiusTask>(m_eta, m_factor, m_minrad);
+  // This task factory knows how to create a task that computes the PetrosianRadius, which
+  // sets also PetrosianLightRadii and PetrosianDiagnostics, and the task that builds the
+  // PetrosianProfileRadii they come from
+  // Note that this function will normally be called if it is not for those properties, but it is good to check
+  if (property_id.getTypeId() == typeid(PetrosianRadius) ||
+      property_id.getTypeId() == typeid(PetrosianLightRadii) ||
+      property_id.getTypeId() == typeid(PetrosianDiagnostics)) {
+    return std::make_shared<PetrosianRadiusTask>(m_eta, m_factor, m_minrad, m_search_mode);
+  }
+  else if (property_id.getTypeId() == typeid(PetrosianProfileRadii)) {
+    // Only the profile reads pixels. The whole group can be done at once, so the detection stamp
+    // is shared between its members
+    if (m_group_tasks) {
+      return std::make_shared<PetrosianProfileGroupTask>(m_eta, m_factor, m_minrad, m_search_mode, m_binning_area,
+                                                         m_binning_factor, m_tier_snr, m_tier_area, m_max_nsigmas,
+                                                         m_blocks);
+    }
+    return std::make_shared<PetrosianProfileTask>(m_eta, m_factor, m_minrad, m_search_mode, m_binning_area,
+                                                  m_binning_factor, m_tier_snr, m_tier_area, m_max_nsigmas, m_blocks);
   }
   return nullptr;
 }
@@ -49,6 +69,20 @@ void PetrosianRadiusTaskFactory::configure(Euclid::Configuration::ConfigManager&
   m_eta = petrosian_config.getEta();
   m_factor = petrosian_config.getFactor();
   m_minrad = petrosian_config.getMinRadius();
+  m_search_mode = petrosian_config.getSearchMode();
+  m_binning_area = petrosian_config.getBinningArea();
+  m_binning_factor = petrosian_config.getBinningFactor();
+  m_tier_snr = petrosian_config.getTierSnr();
+  m_tier_area = petrosian_config.getTierArea();
+  m_max_nsigmas = petrosian_config.getMaxNsigmas();
+  m_group_tasks = petrosian_config.useGroupTasks();
+
+  // The pool is only worth starting if there is something to split
+  std::shared_ptr<ThreadPool> block_pool;
+  if (petrosian_config.getBlockArea() > 0 && petrosian_config.getBlockThreads() > 0) {
+    block_pool = std::make_shared<ThreadPool>(petrosian_config.getBlockThreads());
+  }
+  m_blocks = RowBlocks(petrosian_config.getBlockArea(), block_pool);
 }
 
 
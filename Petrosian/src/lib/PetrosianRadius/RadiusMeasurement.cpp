@@ -0,0 +1,97 @@
+/**
+ * @file src/lib/PetrosianRadius/RadiusMeasurement.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include "Petrosian/PetrosianRadius/RadiusMeasurement.h"
+#include "Petrosian/PetrosianRadius/PetrosianLightRadii.h"
+#include "Petrosian/PetrosianRadius/PetrosianRadius.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Petrosian {
+
+/**
+ * Radii that enclose 50% and 90% of the flux within the aperture. If there is no positive flux
+ * they are not defined, and are set to NaN. If the aperture goes beyond the profile, they are
+ * measured within the profile, and flagged as TRUNCATED
+ */
+static void measureLightRadii(const GrowthCurve& curve, double aperture_radius, RadiusResult& result) {
+  double max_radius = aperture_radius;
+  if (max_radius > curve.getMaxRadius()) {
+    max_radius = curve.getMaxRadius();
+    result.m_flags |= RadiusFlags::TRUNCATED;
+  }
+  double total = curve.getFlux(max_radius);
+  if (!(total > 0)) {
+    result.m_r50 = result.m_r90 = std::numeric_limits<double>::quiet_NaN();
+    return;
+  }
+  result.m_r50 = curve.getRadius(0.5 * total, max_radius);
+  result.m_r90 = curve.getRadius(0.9 * total, max_radius);
+}
+
+RadiusMeasurement::RadiusMeasurement(double eta, double factor, double minrad, RadiusSearchMode search_mode)
+  : m_eta(eta), m_factor(factor), m_minrad(minrad), m_search_mode(search_mode),
+    m_gaussian_radius(getGaussianPetrosianRadius(eta)) {}
+
+RadiusResult RadiusMeasurement::estimate() const {
+  // A Gaussian encloses \f$1 - e^{-r^2/2}\f$ of its flux within r, so the light radii are solved directly
+  double aperture_radius = getApertureRadius(m_gaussian_radius);
+  double total = -std::expm1(-aperture_radius * aperture_radius / 2);
+  return {m_gaussian_radius, std::sqrt(-2 * std::log1p(-0.5 * total)), std::sqrt(-2 * std::log1p(-0.9 * total)),
+          0, RadiusFlags::ESTIMATED};
+}
+
+RadiusResult RadiusMeasurement::measure(const GrowthCurve& curve) const {
+  // ------------------------------------------------------------------------
+  // Look for the Petrosian radius
+  // This has been heavily adapted from SExtractor 2
+  // ------------------------------------------------------------------------
+
+  // We are looking for r
+  // kmean corresponds to this r, kmin to 0.9*r and kmax to 1.1*r (or ~1.2 kmin!)
+  // The search is done over the full resolution profile, without going back to the pixels.
+  // For binned sources it only covers an annulus, but ProfileMeasurement makes sure the radius is there
+  auto search = searchPetrosianRadius(curve.getProfile(), m_eta, m_search_mode, curve.getInnerRadius());
+
+  // As well as the light radii
+  // If the profile reached its maximum extent without crossing η, the radius is only a bound
+  RadiusResult result{search.m_radius, 0., 0., search.m_rings,
+                      search.m_found ? RadiusFlags::NONE : RadiusFlags::NOT_FOUND};
+  measureLightRadii(curve, getApertureRadius(search.m_radius), result);
+  return result;
+}
+
+void RadiusMeasurement::setProperties(SourceXtractor::SourceInterface& source, const RadiusResult& result) const {
+  source.setProperty<PetrosianRadius>(getApertureRadius(result.m_petrosian_radius), result.m_petrosian_radius,
+                                      result.m_flags);
+  source.setProperty<PetrosianLightRadii>(result.m_r50, result.m_r90);
+}
+
+double RadiusMeasurement::getApertureRadius(double petrosian_radius) const {
+  return std::max(petrosian_radius * m_factor, m_minrad);
+}
+
+}  // namespace Petrosian
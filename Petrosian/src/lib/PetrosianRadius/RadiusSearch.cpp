@@ -0,0 +1,227 @@
+/**
+ * @file src/lib/PetrosianRadius/RadiusSearch.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "Petrosian/PetrosianRadius/RadiusSearch.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Petrosian {
+
+// A ring spans from kmin to kmax = 1.2 kmin, and is compared with the area within kmean
+static const double PETRO_RING_WIDTH = 1.2;
+static const double PETRO_RING_MEAN = (1. + PETRO_RING_WIDTH) / 2.;
+
+// The legacy search uses 20 steps over the default extent of the profile. The adaptive one
+// starts with the same step, and doubles it every time. Extended profiles keep it
+static const double PETRO_SEARCH_STEP = PETRO_NSIGMAS / 20.;
+
+// The bisection stops when the bracket is below this fraction of the legacy step.
+// The final interpolation takes care of the remaining error
+static const double PETRO_BISECTION_TOLERANCE = 1. / 8.;
+
+// Or when the η condition is met within this relative tolerance
+static const double PETRO_DIFFERENCE_TOLERANCE = 1e-2;
+
+// The areas are interpolated within the bins, so they are fractional. A ring, or an inner area,
+// covering less than a pixel does not hold enough information to be compared
+static const double PETRO_MIN_RING_AREA = 1.;
+
+/**
+ * Evaluate the η condition for the ring starting at kmin
+ * @return false if the ring or the inner area cover less than a pixel
+ * @param difference
+ *    Output: difference between the ring surface brightness and η times the inner one.
+ *    Negative once the Petrosian radius has been reached
+ * @param inner
+ *    Output: η times the inner surface brightness, to give a scale to the difference
+ */
+static bool evaluateRing(const CumulativeProfile& profile, double eta, double kmin,
+                         double& difference, double& inner) {
+  double kmax = kmin * PETRO_RING_WIDTH;
+  double kmean = kmin * PETRO_RING_MEAN;
+
+  // The outer ring goes from kmin to kmax
+  double flux_outer = profile.getFlux(kmax) - profile.getFlux(kmin);
+  double area_outer = profile.getArea(kmax) - profile.getArea(kmin);
+
+  // The inner area goes up to kmean
+  // Note there is an overlap between kmin and kmean
+  double flux_inner = profile.getFlux(kmean);
+  double area_inner = profile.getArea(kmean);
+
+  // Avoid division by 0, or by a sliver of a pixel
+  if (area_inner < PETRO_MIN_RING_AREA || area_outer < PETRO_MIN_RING_AREA) {
+    return false;
+  }
+  inner = eta * flux_inner / area_inner;
+  difference = flux_outer / area_outer - inner;
+  return true;
+}
+
+static RadiusSearchResult searchLegacy(const CumulativeProfile& profile, double eta, double step_size,
+                                       double min_kmin) {
+  double max_radius = profile.getMaxRadius();
+
+  RadiusSearchResult result{0., 0, false};
+
+  // We step from the inner possible ring, to the outer
+  for (double kmin = step_size; kmin * PETRO_RING_WIDTH < max_radius; kmin += step_size) {
+    if (kmin < min_kmin) {
+      continue;
+    }
+    // This is the target we are testing
+    result.m_radius = kmin * PETRO_RING_MEAN;
+    ++result.m_rings;
+
+    // If the ring is below the threshold, we are done
+    double difference, inner;
+    if (evaluateRing(profile, eta, kmin, difference, inner) && difference < 0) {
+      result.m_found = true;
+      break;
+    }
+  }
+
+  return result;
+}
+
+static RadiusSearchResult searchAdaptive(const CumulativeProfile& profile, double eta, double step_size,
+                                         double min_kmin) {
+  double max_kmin = profile.getMaxRadius() / PETRO_RING_WIDTH;
+  double tolerance = step_size * PETRO_BISECTION_TOLERANCE;
+
+  RadiusSearchResult result{0., 0, false};
+
+  // Bracket the crossing: lower is the last ring known not to meet the condition,
+  // upper the first that does
+  double lower = min_kmin, upper = 0., difference = 0., inner = 0.;
+  double lower_difference = 0., upper_difference = 0.;
+  bool lower_valid = false;
+
+  // Rings grow geometrically, so both compact and extended sources are bracketed quickly
+  for (double step = step_size; !result.m_found; step *= 2) {
+    // Make sure the outermost possible ring is always tested
+    double kmin = std::min(min_kmin + step, max_kmin);
+    ++result.m_rings;
+
+    bool valid = evaluateRing(profile, eta, kmin, difference, inner);
+    if (valid && difference < 0) {
+      upper = kmin;
+      upper_difference = difference;
+      result.m_found = true;
+    }
+    else if (kmin >= max_kmin) {
+      // Not found, settle with the outermost ring
+      result.m_radius = kmin * PETRO_RING_MEAN;
+      return result;
+    }
+    else {
+      lower = kmin;
+      lower_difference = difference;
+      lower_valid = valid;
+    }
+  }
+
+  // Refine the bracket. When both ends are valid, the crossing is interpolated linearly
+  // between them (false position), otherwise the bracket is bisected. To avoid one end
+  // getting stuck, the weight of an end that is kept twice in a row is halved (Illinois)
+  int last_moved = 0;
+  while (upper - lower > tolerance) {
+    double middle = (lower + upper) / 2.;
+    if (lower_valid && lower_difference != upper_difference) {
+      middle = lower + (upper - lower) * lower_difference / (lower_difference - upper_difference);
+    }
+    ++result.m_rings;
+
+    bool valid = evaluateRing(profile, eta, middle, difference, inner);
+    if (valid && difference < 0) {
+      upper = middle;
+      upper_difference = difference;
+      if (last_moved > 0) {
+        lower_difference /= 2.;
+      }
+      last_moved = 1;
+    }
+    else {
+      lower = middle;
+      lower_difference = difference;
+      lower_valid = valid;
+      if (last_moved < 0) {
+        upper_difference /= 2.;
+      }
+      last_moved = -1;
+    }
+
+    // The interpolated estimate is good enough
+    if (valid && std::abs(difference) < PETRO_DIFFERENCE_TOLERANCE * std::abs(inner)) {
+      result.m_radius = middle * PETRO_RING_MEAN;
+      return result;
+    }
+  }
+
+  // Interpolate linearly the crossing between both ends of the bracket
+  double kmin = upper;
+  if (lower_valid && lower_difference != upper_difference) {
+    kmin = lower + (upper - lower) * lower_difference / (lower_difference - upper_difference);
+  }
+  result.m_radius = kmin * PETRO_RING_MEAN;
+  return result;
+}
+
+double getGaussianPetrosianRadius(double eta) {
+  // A Gaussian encloses 1 - exp(-r^2 / 2) of its flux within r, and an area proportional to r^2.
+  // The constant cancels out in the η condition
+  auto flux = [](double r) {
+    return -std::expm1(-r * r / 2);
+  };
+  // Same condition as evaluateRing. Surface brightness falls monotonically, so it is positive for
+  // small rings, and negative beyond the radius
+  auto difference = [eta, &flux](double kmin) {
+    double kmax = kmin * PETRO_RING_WIDTH;
+    double kmean = kmin * PETRO_RING_MEAN;
+    return (flux(kmax) - flux(kmin)) / (kmax * kmax - kmin * kmin) - eta * flux(kmean) / (kmean * kmean);
+  };
+
+  double low = 0., high = 1.;
+  while (difference(high) >= 0 && high < 1e3) {
+    high *= 2;
+  }
+  for (int i = 0; i < 64; ++i) {
+    double middle = (low + high) / 2;
+    (difference(middle) >= 0 ? low : high) = middle;
+  }
+  return (low + high) / 2 * PETRO_RING_MEAN;
+}
+
+RadiusSearchResult searchPetrosianRadius(const CumulativeProfile& profile, double eta, RadiusSearchMode mode,
+                                         double min_kmin) {
+  switch (mode) {
+    case RadiusSearchMode::ADAPTIVE:
+      return searchAdaptive(profile, eta, PETRO_SEARCH_STEP, min_kmin);
+    case RadiusSearchMode::LEGACY:
+    default:
+      return searchLegacy(profile, eta, PETRO_SEARCH_STEP, min_kmin);
+  }
+}
+
+}  // namespace Petrosian
@@ -0,0 +1,335 @@
+/**
+ * @file src/program/PetrosianBenchmark.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+#include <ElementsKernel/ProgramHeaders.h>
+
+#include <SEFramework/Image/VectorImage.h>
+#include <SEFramework/Source/SimpleSource.h>
+
+#include "Petrosian/Common/EllipseAperture.h"
+#include "Petrosian/Common/GlobalLock.h"
+#include "Petrosian/Common/ImageStamp.h"
+#include "Petrosian/Common/RowBlocks.h"
+#include "Petrosian/PetrosianPhotometry/PetrosianPhotometryArrayTask.h"
+#include "Petrosian/PetrosianPhotometry/PhotometryMeasurement.h"
+#include "Petrosian/PetrosianProfile/ProfileMeasurement.h"
+#include "Petrosian/PetrosianRadius/RadiusMeasurement.h"
+
+namespace po = boost::program_options;
+
+using SourceXtractor::SeFloat;
+using SourceXtractor::VectorImage;
+using namespace Petrosian;
+
+// ------------------------------------------------------------------------
+// Every allocation done by the program goes through here, so the benchmark
+// can report how many are done per source
+// ------------------------------------------------------------------------
+
+static std::atomic<uint64_t> s_allocations{0};
+
+void* operator new(std::size_t size) {
+  ++s_allocations;
+  if (void* ptr = std::malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+static Elements::Logging logger = Elements::Logging::getLogger("PetrosianBenchmark");
+
+/**
+ * A single source on its own image
+ */
+struct SyntheticSource {
+  std::shared_ptr<VectorImage<SeFloat>> m_image, m_variance;
+  SourceEllipse m_ellipse;
+};
+
+/**
+ * Generate an elliptical Sérsic profile with gaussian noise.
+ * The ellipse of the source has semi-axes of one effective radius and axis_ratio times that,
+ * so the detection aperture - 6 times the ellipse - covers 6 effective radii.
+ */
+static SyntheticSource generateSource(double effective_radius, double sersic_index, double axis_ratio,
+                                      double amplitude, double noise, std::mt19937& rng) {
+  std::uniform_real_distribution<double> uniform(0., 1.);
+  std::normal_distribution<double> gaussian(0., noise);
+
+  double a = effective_radius, b = effective_radius * axis_ratio;
+  double theta = uniform(rng) * M_PI;
+  double cos_theta = std::cos(theta), sin_theta = std::sin(theta);
+  double cxx = cos_theta * cos_theta / (a * a) + sin_theta * sin_theta / (b * b);
+  double cyy = sin_theta * sin_theta / (a * a) + cos_theta * cos_theta / (b * b);
+  double cxy = 2 * cos_theta * sin_theta * (1. / (a * a) - 1. / (b * b));
+
+  // Enough room for the detection aperture, plus some margin
+  int size = 2 * static_cast<int>(std::ceil(6 * a)) + 8;
+  double centroid_x = size / 2. + uniform(rng), centroid_y = size / 2. + uniform(rng);
+
+  // Approximation of b_n, so the effective radius encloses half of the light
+  double bn = 2 * sersic_index - 1. / 3. + 0.009876 / sersic_index;
+
+  SyntheticSource source;
+  source.m_image = VectorImage<SeFloat>::create(size, size);
+  source.m_variance = VectorImage<SeFloat>::create(size, size);
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      double dx = x - centroid_x, dy = y - centroid_y;
+      double r = std::sqrt(cxx * dx * dx + cyy * dy * dy + cxy * dx * dy);
+      double value = amplitude * std::exp(-bn * (std::pow(r, 1. / sersic_index) - 1.));
+      source.m_image->at(x, y) = static_cast<SeFloat>(value + gaussian(rng));
+      source.m_variance->at(x, y) = static_cast<SeFloat>(noise * noise);
+    }
+  }
+  source.m_ellipse = SourceEllipse{static_cast<float>(cxx), static_cast<float>(cyy), static_cast<float>(cxy),
+                                   static_cast<float>(centroid_x), static_cast<float>(centroid_y)};
+  return source;
+}
+
+/**
+ * Time, pixel and allocation counters for one stage of the measurement
+ */
+struct StageCounters {
+  double m_seconds = 0.;
+  uint64_t m_pixels = 0, m_allocations = 0, m_sources = 0;
+
+  std::string report(const std::string& name) const {
+    std::ostringstream line;
+    line << std::left << std::setw(12) << name << std::right << std::fixed
+         << std::setw(12) << std::setprecision(1) << m_seconds * 1e9 / m_sources << " ns/source";
+    // Stages that do not touch pixels have no pixel rate
+    if (m_pixels > 0) {
+      line << std::setw(10) << std::setprecision(2) << m_pixels / m_seconds / 1e6 << " Mpixel/s";
+    }
+    line << std::setw(8) << std::setprecision(2) << static_cast<double>(m_allocations) / m_sources
+         << " allocations/source";
+    return line.str();
+  }
+};
+
+/**
+ * Measure a stage, running it over all sources
+ */
+template <typename Stage>
+static StageCounters runStage(unsigned nsources, Stage&& stage) {
+  StageCounters counters;
+  auto allocations = s_allocations.load();
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < nsources; ++i) {
+    counters.m_pixels += stage(i);
+  }
+  auto end = std::chrono::steady_clock::now();
+  counters.m_allocations = s_allocations.load() - allocations;
+  counters.m_seconds = std::chrono::duration<double>(end - start).count();
+  counters.m_sources = nsources;
+  return counters;
+}
+
+/**
+ * @class PetrosianBenchmark
+ * @brief
+ *  Times the Petrosian measurements on synthetic sources.
+ * @details
+ *  The tasks need a full SourceXtractor pipeline to get their input properties, so the benchmark
+ *  runs the code they delegate to, over the same stamps they would copy:
+ *  - radius: stamp copy of the detection image, ProfileMeasurement and RadiusMeasurement
+ *  - photometry: stamp copy of the measurement image, and PhotometryMeasurement, once per image
+ *  - array: PetrosianPhotometryArrayTask, gathering the photometries of all images
+ *  Each stage runs once over all sources before being timed, so thread local buffers are warm,
+ *  as they would be after the first few sources of a real run.
+ */
+class PetrosianBenchmark : public Elements::Program {
+
+public:
+
+  po::options_description defineSpecificProgramOptions() override {
+    po::options_description options{};
+    options.add_options()
+      ("effective-radius", po::value<std::vector<double>>()->multitoken()->default_value({2, 4, 8, 16, 32}, "2 4 8 16 32"),
+       "Effective radii of the synthetic sources, in pixels. One benchmark per value")
+      ("sersic-index", po::value<double>()->default_value(1.), "Sérsic index")
+      ("axis-ratio", po::value<double>()->default_value(0.7), "Axis ratio (b/a)")
+      ("amplitude", po::value<double>()->default_value(10.), "Surface brightness at the effective radius")
+      ("noise", po::value<double>()->default_value(1.), "Standard deviation of the gaussian noise")
+      ("sources", po::value<unsigned>()->default_value(1000), "Number of sources measured per benchmark")
+      ("variants", po::value<unsigned>()->default_value(16), "Number of distinct sources generated per benchmark")
+      ("images", po::value<unsigned>()->default_value(3), "Number of measurement images")
+      ("search", po::value<std::string>()->default_value("LEGACY"), "Radius search: LEGACY or ADAPTIVE")
+      ("binning-area", po::value<int>()->default_value(0), "Binning area for the coarse radius search")
+      ("block-area", po::value<int>()->default_value(0), "Stamps with more pixels are reduced by blocks of rows")
+      ("block-threads", po::value<int>()->default_value(0), "Threads used to reduce the blocks of rows")
+      ("exact-overlap", po::value<bool>()->default_value(false), "Weight the pixels on the edge of the aperture")
+      ("factors", po::value<std::vector<double>>()->multitoken()->default_value({}, ""),
+       "Factors of additional apertures, measured in the same pass")
+      ("seed", po::value<unsigned>()->default_value(42), "Seed for the random generator");
+    return options;
+  }
+
+  Elements::ExitCode mainMethod(std::map<std::string, po::variable_value>& args) override {
+    auto sersic_index = args.at("sersic-index").as<double>();
+    auto axis_ratio = args.at("axis-ratio").as<double>();
+    auto amplitude = args.at("amplitude").as<double>();
+    auto noise = args.at("noise").as<double>();
+    auto nsources = args.at("sources").as<unsigned>();
+    auto nvariants = args.at("variants").as<unsigned>();
+    auto nimages = args.at("images").as<unsigned>();
+    auto exact_overlap = args.at("exact-overlap").as<bool>();
+    auto factors = args.at("factors").as<std::vector<double>>();
+    auto search_mode = args.at("search").as<std::string>() == "ADAPTIVE" ? RadiusSearchMode::ADAPTIVE
+                                                                         : RadiusSearchMode::LEGACY;
+    std::mt19937 rng(args.at("seed").as<unsigned>());
+
+    std::shared_ptr<ThreadPool> block_pool;
+    if (args.at("block-threads").as<int>() > 0) {
+      block_pool = std::make_shared<ThreadPool>(args.at("block-threads").as<int>());
+    }
+    RowBlocks blocks(args.at("block-area").as<int>(), block_pool);
+
+    // Same defaults as PetrosianConfig
+    ProfileMeasurement profile_measurement(0.2, 2.0, 3.5, search_mode, args.at("binning-area").as<int>(), 4, 0., 0,
+                                           6., blocks);
+    RadiusMeasurement radius_measurement(0.2, 2.0, 3.5, search_mode);
+    std::vector<PhotometryMeasurement> photometry_measurements;
+    std::vector<unsigned> images;
+    for (unsigned i = 0; i < nimages; ++i) {
+      photometry_measurements.emplace_back(i, FrameSize{0, 0}, 0., true, exact_overlap, factors, 3.5, "",
+                                           blocks);
+      images.emplace_back(i);
+    }
+    PetrosianPhotometryArrayTask array_task(images);
+
+    const SeFloat variance_threshold = std::numeric_limits<SeFloat>::max();
+    const double gain = 1.;
+
+    for (auto effective_radius : args.at("effective-radius").as<std::vector<double>>()) {
+      std::vector<SyntheticSource> variants;
+      for (unsigned i = 0; i < nvariants; ++i) {
+        variants.emplace_back(generateSource(effective_radius, sersic_index, axis_ratio, amplitude, noise, rng));
+      }
+      std::vector<double> radii(nvariants), petrosian_radii(nvariants), neighbour_radii(nvariants);
+      std::vector<PhotometryAperture> apertures(nvariants);
+      std::vector<SourceXtractor::SimpleSource> sources(nvariants);
+      ImageStamp stamp;
+
+      // Copy the detection stamp and build the profile, as PetrosianProfileTask does, which reads
+      // the radius from it
+      auto radius_stage = [&](unsigned i) -> uint64_t {
+        auto& source = variants[i % nvariants];
+        auto spans = ProfileMeasurement::getSpans(source.m_ellipse);
+        {
+          GlobalLock lock;
+          stamp.copy(source.m_image, source.m_variance, spans.getMinPixel(), spans.getMaxPixel());
+        }
+        auto profile = profile_measurement.compute(stamp, source.m_ellipse, variance_threshold);
+        petrosian_radii[i % nvariants] = profile.getRadius().m_petrosian_radius;
+        neighbour_radii[i % nvariants] = profile.getNeighbourRadius();
+        radii[i % nvariants] = radius_measurement.getApertureRadius(petrosian_radii[i % nvariants]);
+        return static_cast<uint64_t>(stamp.getWidth()) * stamp.getHeight();
+      };
+      radius_stage(0);
+      runStage(nvariants, radius_stage);
+      auto radius_counters = runStage(nsources, radius_stage);
+
+      // The measurement images are the detection one, so the aperture is not transformed.
+      // The stamp must cover the biggest of the additional apertures too
+      for (unsigned i = 0; i < nvariants; ++i) {
+        const auto& ellipse = variants[i].m_ellipse;
+        double max_radius = radii[i];
+        for (auto factor : factors) {
+          max_radius = std::max(max_radius, std::max(petrosian_radii[i] * factor, 3.5));
+        }
+        EllipseAperture aperture(ellipse.m_cxx, ellipse.m_cyy, ellipse.m_cxy, max_radius,
+                                 ellipse.m_centroid_x, ellipse.m_centroid_y);
+        auto min_pixel = aperture.getMinPixel();
+        auto max_pixel = aperture.getMaxPixel();
+        apertures[i] = PhotometryAperture{ellipse.m_cxx, ellipse.m_cyy, ellipse.m_cxy, radii[i], petrosian_radii[i],
+                                          neighbour_radii[i], ellipse.m_centroid_x, ellipse.m_centroid_y,
+                                          {min_pixel.m_x - 1, min_pixel.m_y - 1},
+                                          {max_pixel.m_x + 1, max_pixel.m_y + 1}};
+      }
+
+      // Copy the measurement stamp and measure, as PetrosianPhotometryTask does, for each image
+      auto photometry_stage = [&](unsigned i) -> uint64_t {
+        auto& source = variants[i % nvariants];
+        auto& aperture = apertures[i % nvariants];
+        uint64_t pixels = 0;
+        for (auto& measurement : photometry_measurements) {
+          {
+            GlobalLock lock;
+            stamp.copy(source.m_image, source.m_variance, aperture.m_min_pixel, aperture.m_max_pixel);
+          }
+          measurement.measure(sources[i % nvariants], aperture, stamp, variance_threshold, gain);
+          pixels += static_cast<uint64_t>(stamp.getWidth()) * stamp.getHeight();
+        }
+        return pixels;
+      };
+      runStage(nvariants, photometry_stage);
+      auto photometry_counters = runStage(nsources, photometry_stage);
+
+      // Gather the photometries
+      auto array_stage = [&](unsigned i) -> uint64_t {
+        array_task.computeProperties(sources[i % nvariants]);
+        return 0;
+      };
+      runStage(nvariants, array_stage);
+      auto array_counters = runStage(nsources, array_stage);
+
+      logger.info() << "Effective radius " << effective_radius << " pixels, "
+                    << "mean Petrosian radius " << std::accumulate(radii.begin(), radii.end(), 0.) / nvariants;
+      logger.info() << radius_counters.report("Radius");
+      logger.info() << photometry_counters.report("Photometry");
+      logger.info() << array_counters.report("Array");
+    }
+
+    return Elements::ExitCode::OK;
+  }
+};
+
+MAIN_FOR(PetrosianBenchmark)
@@ -0,0 +1,184 @@
+/**
+ * @file tests/src/Common/ApertureFlux_test.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+
+#include <SEFramework/Image/VectorImage.h>
+
+#include "Petrosian/Common/ApertureFlux.h"
+#include "Petrosian/Common/CumulativeProfile.h"
+
+using namespace Petrosian;
+using SourceXtractor::SeFloat;
+using SourceXtractor::VectorImage;
+
+namespace {
+
+static const int SIZE = 64;
+static const double CENTROID_X = 31.3, CENTROID_Y = 32.7;
+static const double CXX = 0.5, CYY = 1., CXY = 0.1;
+
+// Smooth elliptical gaussian, with the same shape as the apertures, and a flat variance
+struct GaussianFixture {
+  std::shared_ptr<VectorImage<SeFloat>> m_image, m_variance;
+  ImageStamp m_stamp;
+
+  GaussianFixture() : m_image(VectorImage<SeFloat>::create(SIZE, SIZE)),
+                      m_variance(VectorImage<SeFloat>::create(SIZE, SIZE)) {
+    EllipseAperture shape(CXX, CYY, CXY, 1., CENTROID_X, CENTROID_Y);
+    for (int y = 0; y < SIZE; ++y) {
+      for (int x = 0; x < SIZE; ++x) {
+        m_image->at(x, y) = static_cast<SeFloat>(100. * std::exp(-shape.getRadiusSquared(x, y) / 18.));
+        m_variance->at(x, y) = 1.;
+      }
+    }
+    m_stamp.copy(m_image, m_variance, {0, 0}, {SIZE - 1, SIZE - 1});
+  }
+
+  // Profile of the stamp, binned on the r^2 of the apertures
+  CumulativeProfile getProfile(double max_radius, unsigned nbins) const {
+    EllipseAperture shape(CXX, CYY, CXY, max_radius, CENTROID_X, CENTROID_Y);
+    CumulativeProfile profile(max_radius, nbins);
+    for (int y = 0; y < SIZE; ++y) {
+      for (int x = 0; x < SIZE; ++x) {
+        profile.add(shape.getRadiusSquared(x, y), m_stamp.getValue(x, y));
+      }
+    }
+    profile.accumulate();
+    return profile;
+  }
+
+  ApertureFlux measure(double radius) const {
+    return measureApertureFlux(EllipseAperture(CXX, CYY, CXY, radius, CENTROID_X, CENTROID_Y), m_stamp, 10., false);
+  }
+
+  // Mark a few pixels as bad, so symmetry has something to replace
+  void addBadPixels() {
+    for (int i = 0; i < 20; ++i) {
+      m_variance->at(20 + i, 28 + (i * 7) % 9) = 100.;
+    }
+    m_stamp.copy(m_image, m_variance, {0, 0}, {SIZE - 1, SIZE - 1});
+  }
+
+  std::vector<EllipseAperture> getApertures() const {
+    std::vector<EllipseAperture> apertures;
+    for (double radius : {1.5, 3., 4.5, 9., 15.}) {
+      apertures.emplace_back(CXX, CYY, CXY, radius, CENTROID_X, CENTROID_Y);
+    }
+    return apertures;
+  }
+};
+
+void checkSameFlux(const ApertureFlux& a, const ApertureFlux& b) {
+  BOOST_CHECK_CLOSE(a.m_flux, b.m_flux, 1e-9);
+  BOOST_CHECK_CLOSE(a.m_total_area, b.m_total_area, 1e-9);
+  BOOST_CHECK_CLOSE(a.m_variance, b.m_variance, 1e-9);
+  BOOST_CHECK_CLOSE(a.m_bad_area, b.m_bad_area, 1e-9);
+  BOOST_CHECK(a.m_flags == b.m_flags);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE (ApertureFlux_test)
+
+//-----------------------------------------------------------------------------
+
+// On the edges of the bins, the profile holds exactly the pixels inside the aperture
+BOOST_FIXTURE_TEST_CASE(ProfileBinEdge_test, GaussianFixture) {
+  auto profile = getProfile(20., 1024);
+  double bin_width = 20. * 20. / 1024;
+  for (unsigned bin : {16u, 64u, 200u, 512u, 1000u}) {
+    double radius = std::sqrt(bin * bin_width);
+    auto measurement = measure(radius);
+    BOOST_CHECK_CLOSE(profile.getFlux(radius), measurement.m_flux, 1e-6);
+    BOOST_CHECK_CLOSE(profile.getArea(radius), measurement.m_total_area, 1e-6);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// Elsewhere, the interpolated profile only approximates the pixels, which is why the photometry
+// is always measured on them
+BOOST_FIXTURE_TEST_CASE(ProfileInterpolation_test, GaussianFixture) {
+  auto profile = getProfile(20., 1024);
+  for (double radius : {2.3, 3.5, 5.1, 7.7, 12.9}) {
+    auto measurement = measure(radius);
+    BOOST_CHECK_CLOSE(profile.getFlux(radius), measurement.m_flux, 1.);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// Several apertures in one pass give the same as one pass each
+BOOST_FIXTURE_TEST_CASE(Fluxes_test, GaussianFixture) {
+  auto apertures = getApertures();
+  std::vector<ApertureFlux> fluxes;
+  measureApertureFluxes(apertures, m_stamp, 10., false, fluxes);
+
+  BOOST_REQUIRE_EQUAL(fluxes.size(), apertures.size());
+  for (size_t i = 0; i < apertures.size(); ++i) {
+    checkSameFlux(fluxes[i], measureApertureFlux(apertures[i], m_stamp, 10., false));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// Same, replacing bad pixels by their symmetric
+BOOST_FIXTURE_TEST_CASE(FluxesSymmetry_test, GaussianFixture) {
+  addBadPixels();
+  auto apertures = getApertures();
+  std::vector<ApertureFlux> fluxes;
+  measureApertureFluxes(apertures, m_stamp, 10., true, fluxes);
+
+  BOOST_REQUIRE_EQUAL(fluxes.size(), apertures.size());
+  for (size_t i = 0; i < apertures.size(); ++i) {
+    checkSameFlux(fluxes[i], measureApertureFlux(apertures[i], m_stamp, 10., true));
+  }
+  BOOST_CHECK_GT(fluxes.back().m_bad_area, 0.);
+}
+
+//-----------------------------------------------------------------------------
+
+// Same, weighting the pixels on the edges by their overlap
+BOOST_FIXTURE_TEST_CASE(FluxesOverlap_test, GaussianFixture) {
+  addBadPixels();
+  auto apertures = getApertures();
+  std::vector<PixelOverlap> overlaps;
+  for (const auto& aperture : apertures) {
+    overlaps.emplace_back(aperture);
+  }
+  std::vector<ApertureFlux> fluxes;
+  measureApertureFluxes(apertures, overlaps, m_stamp, 10., true, fluxes);
+
+  BOOST_REQUIRE_EQUAL(fluxes.size(), apertures.size());
+  for (size_t i = 0; i < apertures.size(); ++i) {
+    checkSameFlux(fluxes[i], measureApertureFlux(apertures[i], overlaps[i], m_stamp, 10., true));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
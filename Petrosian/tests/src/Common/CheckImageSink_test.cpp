@@ -0,0 +1,128 @@
+/**
+ * @file tests/src/Common/CheckImageSink_test.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include <SEImplementation/CheckImages/CheckImages.h>
+
+#include "Petrosian/Common/CheckImageSink.h"
+
+using namespace Petrosian;
+using SourceXtractor::CheckImages;
+using SourceXtractor::SeFloat;
+
+namespace {
+
+static const int WIDTH = 200, HEIGHT = 150;
+
+// Aperture i of a set spread over the image, some of them crossing its borders. The centroids are
+// off the pixel grid, as a pixel whose center is exactly on the edge may go either way
+EllipseAperture getAperture(int i) {
+  double x = std::fmod(i * 37.3 + 0.137, WIDTH), y = std::fmod(i * 23.7 + 0.291, HEIGHT);
+  return EllipseAperture(0.5 + 0.01 * (i % 7), 1., 0.1 * ((i % 5) - 2), 3. + i % 11, x, y);
+}
+
+// Check image as SourceXtractor::fillAperture would leave it: the value of the last aperture over each pixel
+std::vector<SeFloat> drawBruteForce(const std::vector<EllipseAperture>& apertures, const std::vector<float>& values) {
+  std::vector<SeFloat> image(WIDTH * HEIGHT, 0.);
+  for (size_t i = 0; i < apertures.size(); ++i) {
+    for (int y = 0; y < HEIGHT; ++y) {
+      for (int x = 0; x < WIDTH; ++x) {
+        if (apertures[i].getArea(x, y) > 0) {
+          image[x + y * WIDTH] = values[i];
+        }
+      }
+    }
+  }
+  return image;
+}
+
+// Pixels of the check image with the given name
+std::vector<SeFloat> readCheckImage(const std::string& name) {
+  auto image = CheckImages::getInstance().getWriteableCheckImage(name, WIDTH, HEIGHT);
+  auto chunk = image->getChunk(0, 0, WIDTH, HEIGHT);
+  std::vector<SeFloat> pixels(WIDTH * HEIGHT);
+  for (int y = 0; y < HEIGHT; ++y) {
+    for (int x = 0; x < WIDTH; ++x) {
+      pixels[x + y * WIDTH] = chunk->getValue(x, y);
+    }
+  }
+  return pixels;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE (CheckImageSink_test)
+
+//-----------------------------------------------------------------------------
+
+// Drawn from one thread, the apertures are written in order, clipped to the image
+BOOST_AUTO_TEST_CASE(Sequential_test) {
+  std::vector<EllipseAperture> apertures;
+  std::vector<float> values;
+  CheckImageSink sink("petrosian_sink_sequential");
+  for (int i = 0; i < 100; ++i) {
+    apertures.emplace_back(getAperture(i));
+    values.emplace_back(static_cast<float>(i + 1));
+    sink.fillAperture(apertures.back(), WIDTH, HEIGHT, values.back());
+  }
+  BOOST_CHECK(readCheckImage("petrosian_sink_sequential") == drawBruteForce(apertures, values));
+}
+
+//-----------------------------------------------------------------------------
+
+// Drawn from several threads at once, no aperture is lost. They all have the same value, so the
+// order in which they are written does not matter
+BOOST_AUTO_TEST_CASE(Concurrent_test) {
+  const int nthreads = 8, napertures = 400;
+  std::vector<EllipseAperture> apertures;
+  for (int i = 0; i < napertures; ++i) {
+    apertures.emplace_back(getAperture(i));
+  }
+
+  CheckImageSink sink("petrosian_sink_concurrent");
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nthreads; ++t) {
+    threads.emplace_back([&sink, &apertures, t]() {
+      for (size_t i = t; i < apertures.size(); i += nthreads) {
+        sink.fillAperture(apertures[i], WIDTH, HEIGHT, 1.f);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<float> values(napertures, 1.f);
+  BOOST_CHECK(readCheckImage("petrosian_sink_concurrent") == drawBruteForce(apertures, values));
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
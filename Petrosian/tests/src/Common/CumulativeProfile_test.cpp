@@ -0,0 +1,142 @@
+/**
+ * @file tests/src/Common/CumulativeProfile_test.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+
+#include "Petrosian/Common/CumulativeProfile.h"
+
+using namespace Petrosian;
+
+namespace {
+
+// Check the enclosed flux never decreases, and that the radius enclosing each fraction of it is found
+void checkMonotonic(const CumulativeProfile& profile) {
+  double previous = 0.;
+  for (double radius = 0.; radius <= profile.getMaxRadius(); radius += profile.getMaxRadius() / 500.) {
+    double flux = profile.getFlux(radius);
+    BOOST_CHECK_GE(flux, previous);
+    previous = flux;
+  }
+  double total = profile.getFlux(profile.getMaxRadius());
+  for (double fraction : {0.1, 0.5, 0.9}) {
+    double radius = profile.getRadius(fraction * total, 0., profile.getMaxRadius());
+    BOOST_CHECK(std::isfinite(radius));
+    BOOST_CHECK_CLOSE(profile.getFlux(radius), fraction * total, 1e-9);
+  }
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE (CumulativeProfile_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Accumulate_test) {
+  CumulativeProfile profile(2., 16);
+  profile.add(0.1, 1.);
+  profile.add(1.1, 2.);
+  profile.add(3.9, 4.);
+  // Beyond the profile
+  profile.add(4., 8.);
+  profile.accumulate();
+
+  BOOST_CHECK_EQUAL(profile.getMaxRadius(), 2.);
+  BOOST_CHECK_EQUAL(profile.getFlux(0.), 0.);
+  BOOST_CHECK_EQUAL(profile.getFlux(2.), 7.);
+  BOOST_CHECK_EQUAL(profile.getArea(2.), 3.);
+  // Bins are 0.25 wide in r^2, and flux is spread evenly within them
+  BOOST_CHECK_CLOSE(profile.getFlux(std::sqrt(1.125)), 1. + 2. * 0.5, 1e-9);
+  checkMonotonic(profile);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Extend_test) {
+  CumulativeProfile profile(2., 16);
+  profile.add(0.1, 1.);
+  profile.add(3.9, 1.);
+  profile.accumulate();
+
+  profile.extend(3.);
+  BOOST_CHECK_GE(profile.getMaxRadius(), 3.);
+  profile.add(5., 1.);
+  // Pixels of the new annulus that, by rounding, fall short of the previous edge
+  profile.add(3.99, 1.);
+  profile.add(3.5, 1.);
+  profile.accumulate();
+
+  BOOST_CHECK_EQUAL(profile.getFlux(profile.getMaxRadius()), 5.);
+  BOOST_CHECK_EQUAL(profile.getArea(profile.getMaxRadius()), 5.);
+  // What was there before is not changed
+  BOOST_CHECK_EQUAL(profile.getFlux(2.), 2.);
+  checkMonotonic(profile);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(ExtendMerge_test) {
+  CumulativeProfile profile(2., 16);
+  profile.add(0.1, 1.);
+  profile.add(3.9, 1.);
+  profile.accumulate();
+  profile.extend(3.);
+
+  // The new annulus is filled by blocks, as for big stamps
+  CumulativeProfile first, second;
+  first.reset(profile);
+  second.reset(profile);
+  first.add(5., 1.);
+  first.add(3.5, 1.);
+  second.add(3.99, 1.);
+  second.add(8.5, 1.);
+  first.merge(second);
+  profile.merge(first);
+  profile.accumulate();
+
+  BOOST_CHECK_EQUAL(profile.getFlux(profile.getMaxRadius()), 6.);
+  BOOST_CHECK_EQUAL(profile.getFlux(2.), 2.);
+  checkMonotonic(profile);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Reset_test) {
+  CumulativeProfile profile(2., 16);
+  profile.add(1., 1.);
+  profile.accumulate();
+  profile.extend(3.);
+  profile.reset(1., 4);
+  profile.add(0.5, 3.);
+  profile.accumulate();
+
+  BOOST_CHECK_EQUAL(profile.getMaxRadius(), 1.);
+  BOOST_CHECK_EQUAL(profile.getFlux(1.), 3.);
+  BOOST_CHECK_CLOSE(profile.getRadius(1.5, 0., 1.), std::sqrt(0.625), 1e-9);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,104 @@
+/**
+ * @file tests/src/Common/EllipseAperture_test.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <tuple>
+
+#include <SEFramework/Aperture/EllipticalAperture.h>
+#include <SEFramework/Aperture/TransformedAperture.h>
+
+#include "Petrosian/Common/EllipseAperture.h"
+
+using namespace Petrosian;
+using SourceXtractor::SeFloat;
+
+namespace {
+
+static const double CXX = 0.5, CYY = 1., CXY = 0.1, RADIUS = 6.;
+static const double CENTROID_X = 31.3, CENTROID_Y = 32.7;
+
+using Jacobian = std::tuple<double, double, double, double>;
+
+// Identity, scale, rotation, shear and a flip
+static const Jacobian JACOBIANS[] = {
+  Jacobian{1., 0., 0., 1.}, Jacobian{2., 0., 0., 0.5}, Jacobian{0.8, -0.6, 0.6, 0.8},
+  Jacobian{1., 0.3, 0., 1.}, Jacobian{-1.2, 0.1, 0.2, 0.9}
+};
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE (EllipseAperture_test)
+
+//-----------------------------------------------------------------------------
+
+// On the detection frame the coefficients are kept as they are
+BOOST_AUTO_TEST_CASE(Identity_test) {
+  auto aperture = EllipseAperture::transform(CXX, CYY, CXY, RADIUS, Jacobian{1., 0., 0., 1.}, CENTROID_X, CENTROID_Y);
+  BOOST_CHECK_EQUAL(aperture.getCxx(), CXX);
+  BOOST_CHECK_EQUAL(aperture.getCyy(), CYY);
+  BOOST_CHECK_EQUAL(aperture.getCxy(), CXY);
+  BOOST_CHECK_EQUAL(aperture.getRadius(), RADIUS);
+}
+
+//-----------------------------------------------------------------------------
+
+// The folded quadratic form gives the same radius as SourceXtractor::TransformedAperture on every pixel
+BOOST_AUTO_TEST_CASE(Transform_test) {
+  for (const auto& jacobian : JACOBIANS) {
+    auto aperture = EllipseAperture::transform(CXX, CYY, CXY, RADIUS, jacobian, CENTROID_X, CENTROID_Y);
+    auto elliptical = std::make_shared<SourceXtractor::EllipticalAperture>(CXX, CYY, CXY, RADIUS);
+    SourceXtractor::TransformedAperture transformed(elliptical, jacobian);
+
+    for (int y = 10; y < 56; y += 3) {
+      for (int x = 10; x < 56; x += 3) {
+        double expected = transformed.getRadiusSquared(CENTROID_X, CENTROID_Y, x, y);
+        BOOST_CHECK_SMALL(aperture.getRadiusSquared(x, y) - expected, 1e-4 * (1. + expected));
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// Every pixel inside the aperture falls within its bounding box
+BOOST_AUTO_TEST_CASE(BoundingBox_test) {
+  for (const auto& jacobian : JACOBIANS) {
+    auto aperture = EllipseAperture::transform(CXX, CYY, CXY, RADIUS, jacobian, CENTROID_X, CENTROID_Y);
+    auto min_pixel = aperture.getMinPixel(), max_pixel = aperture.getMaxPixel();
+    for (int y = 0; y < 64; ++y) {
+      for (int x = 0; x < 64; ++x) {
+        if (aperture.getArea(x, y) > 0) {
+          BOOST_CHECK(x >= min_pixel.m_x && x <= max_pixel.m_x && y >= min_pixel.m_y && y <= max_pixel.m_y);
+        }
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
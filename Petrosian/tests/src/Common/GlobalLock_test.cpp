@@ -0,0 +1,103 @@
+/**
+ * @file tests/src/Common/GlobalLock_test.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include <SEImplementation/Measurement/MultithreadedMeasurement.h>
+
+#include "Petrosian/Common/GlobalLock.h"
+
+using namespace Petrosian;
+using SourceXtractor::MultithreadedMeasurement;
+
+BOOST_AUTO_TEST_SUITE (GlobalLock_test)
+
+//-----------------------------------------------------------------------------
+
+// A free mutex is counted as acquired, without contention nor wait
+BOOST_AUTO_TEST_CASE(Free_test) {
+  auto acquisitions = GlobalLock::getAcquisitions();
+  auto contentions = GlobalLock::getContentions();
+  for (int i = 0; i < 3; ++i) {
+    GlobalLock lock;
+    BOOST_CHECK_EQUAL(lock.getWaitTime(), 0u);
+  }
+  BOOST_CHECK_EQUAL(GlobalLock::getAcquisitions(), acquisitions + 3);
+  BOOST_CHECK_EQUAL(GlobalLock::getContentions(), contentions);
+}
+
+//-----------------------------------------------------------------------------
+
+// A mutex held by another thread is counted as a contention, and the wait is measured
+BOOST_AUTO_TEST_CASE(Contention_test) {
+  auto acquisitions = GlobalLock::getAcquisitions();
+  auto contentions = GlobalLock::getContentions();
+
+  std::promise<void> locked, release;
+  std::thread holder([&locked, &release]() {
+    std::lock_guard<std::recursive_mutex> lock(MultithreadedMeasurement::g_global_mutex);
+    locked.set_value();
+    release.get_future().wait();
+  });
+  locked.get_future().wait();
+
+  auto waiter = std::async(std::launch::async, []() {
+    GlobalLock lock;
+    return lock.getWaitTime();
+  });
+  // Release it only once the other thread has found it held
+  while (GlobalLock::getContentions() == contentions) {
+    std::this_thread::yield();
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  release.set_value();
+  auto wait_time = waiter.get();
+  holder.join();
+
+  BOOST_CHECK_GE(wait_time, 10000000u);
+  BOOST_CHECK_EQUAL(GlobalLock::getAcquisitions(), acquisitions + 1);
+  BOOST_CHECK_EQUAL(GlobalLock::getContentions(), contentions + 1);
+}
+
+//-----------------------------------------------------------------------------
+
+// The mutex is recursive, so the thread holding it can take it again without contention
+BOOST_AUTO_TEST_CASE(Recursive_test) {
+  auto contentions = GlobalLock::getContentions();
+  {
+    GlobalLock outer;
+    GlobalLock inner;
+    BOOST_CHECK_EQUAL(inner.getWaitTime(), 0u);
+  }
+  BOOST_CHECK_EQUAL(GlobalLock::getContentions(), contentions);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,106 @@
+/**
+ * @file tests/src/Common/PixelOverlap_test.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+
+#include "Petrosian/Common/PixelOverlap.h"
+
+using namespace Petrosian;
+
+namespace {
+
+// Sum of the overlap of all the pixels the ellipse may touch
+double getTotalArea(const EllipseAperture& ellipse) {
+  PixelOverlap overlap(ellipse);
+  auto min_pixel = ellipse.getMinPixel(), max_pixel = ellipse.getMaxPixel();
+  double area = 0.;
+  for (int y = min_pixel.m_y - 1; y <= max_pixel.m_y + 1; ++y) {
+    for (int x = min_pixel.m_x - 1; x <= max_pixel.m_x + 1; ++x) {
+      double pixel = overlap.getArea(x, y);
+      BOOST_REQUIRE(pixel >= 0. && pixel <= 1.);
+      area += pixel;
+    }
+  }
+  return area;
+}
+
+// Area of the ellipse cxx dx^2 + cyy dy^2 + cxy dx dy <= R^2
+double getEllipseArea(double cxx, double cyy, double cxy, double radius) {
+  return M_PI * radius * radius / std::sqrt(cxx * cyy - cxy * cxy / 4.);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE (PixelOverlap_test)
+
+//-----------------------------------------------------------------------------
+
+// On a huge circle, the edge crossing a pixel is a straight line, and the covered fraction is known
+BOOST_AUTO_TEST_CASE(StraightEdge_test) {
+  const double radius = 1e4;
+  for (double offset : {-0.4, -0.2, 0., 0.1, 0.3}) {
+    // Vertical edge at x = offset
+    PixelOverlap vertical(EllipseAperture(1., 1., 0., radius, offset - radius, 0.));
+    BOOST_CHECK_CLOSE(vertical.getArea(0, 0), 0.5 + offset, 0.1);
+    // Diagonal edge at x + y = offset, which cuts a triangle off a corner when |offset| > 0
+    double d = radius / std::sqrt(2.);
+    PixelOverlap diagonal(EllipseAperture(1., 1., 0., radius, offset / 2. - d, offset / 2. - d));
+    double corner = (1. - std::fabs(offset)) * (1. - std::fabs(offset)) / 2.;
+    BOOST_CHECK_CLOSE(diagonal.getArea(0, 0), offset >= 0 ? 1. - corner : corner, 0.1);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// The overlaps add up to the area of the ellipse, whatever its shape and position. Down to apertures
+// less than a pixel across, whose edge curves more than the subdivision can follow, within 2%
+BOOST_AUTO_TEST_CASE(TotalArea_test) {
+  struct Shape { double cxx, cyy, cxy; };
+  for (auto shape : {Shape{1., 1., 0.}, Shape{0.5, 1., 0.1}, Shape{0.2, 1.5, -0.8}, Shape{4., 0.3, 0.5}}) {
+    for (double radius : {0.8, 1.5, 3., 7.5, 20.}) {
+      for (double centroid : {0., 0.25, 0.5, 0.73}) {
+        EllipseAperture ellipse(shape.cxx, shape.cyy, shape.cxy, radius, 50. + centroid, 50. - centroid / 3.);
+        double expected = getEllipseArea(shape.cxx, shape.cyy, shape.cxy, radius);
+        BOOST_CHECK_CLOSE(getTotalArea(ellipse), expected, 2.);
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// Big ellipses are much more accurate, as the edge barely curves within a pixel
+BOOST_AUTO_TEST_CASE(TotalAreaBig_test) {
+  for (double centroid : {0., 0.25, 0.5, 0.73}) {
+    EllipseAperture ellipse(0.5, 1., 0.1, 30., 100. + centroid, 100. - centroid / 3.);
+    BOOST_CHECK_CLOSE(getTotalArea(ellipse), getEllipseArea(0.5, 1., 0.1, 30.), 0.01);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
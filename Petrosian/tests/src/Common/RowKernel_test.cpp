@@ -0,0 +1,98 @@
+/**
+ * @file tests/src/Common/RowKernel_test.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Petrosian/Common/RowKernel.h"
+
+using namespace Petrosian;
+
+namespace {
+
+// Longer than two AVX-512 vectors, so every implementation goes through its main loop and its tail
+const int MAX_LENGTH = 53;
+
+struct RowKernel_Fixture {
+  std::vector<float> ref_r2, r2;
+
+  RowKernel_Fixture() : ref_r2(MAX_LENGTH), r2(MAX_LENGTH) {}
+
+  // Compare, bit for bit, every implementation with the scalar one
+  void check(const EllipseRow& row) {
+    for (int n = 0; n <= MAX_LENGTH; ++n) {
+      evaluateRowRadiusScalar(row, n, ref_r2.data());
+      for (const auto& kernel : getRowKernels()) {
+        BOOST_TEST_CONTEXT(kernel.m_name << " with " << n << " pixels") {
+          std::fill(r2.begin(), r2.end(), -1.f);
+          kernel.m_radius(row, n, r2.data());
+          BOOST_CHECK(std::memcmp(r2.data(), ref_r2.data(), n * sizeof(float)) == 0);
+          // Nothing is written past the end of the row
+          for (int i = n; i < MAX_LENGTH; ++i) {
+            BOOST_CHECK_EQUAL(r2[i], -1.f);
+          }
+        }
+      }
+    }
+  }
+};
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE (RowKernel_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Kernels_test) {
+  auto kernels = getRowKernels();
+  BOOST_REQUIRE(!kernels.empty());
+  BOOST_CHECK_EQUAL(std::string(kernels.front().m_name), std::string(getRowKernelName()));
+  BOOST_CHECK_EQUAL(std::string(kernels.back().m_name), "scalar");
+  BOOST_TEST_MESSAGE("Row kernels: " << kernels.size() << ", using " << getRowKernelName());
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(Radius_test, RowKernel_Fixture) {
+  check({-20.37f, 0.31f, -0.123f * 4.6f, 0.57f * 4.6f * 4.6f});
+  check({0.5f, 1.7f, 0.25f, 3.1f});
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(Scalar_test, RowKernel_Fixture) {
+  EllipseRow row{-3.f, 1.f, 0.f, 0.f};
+  evaluateRowRadiusScalar(row, MAX_LENGTH, r2.data());
+  for (int i = 0; i < MAX_LENGTH; ++i) {
+    BOOST_CHECK_EQUAL(r2[i], (i - 3.f) * (i - 3.f));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,125 @@
+/**
+ * @file tests/src/Common/ThreadPool_test.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+#include "Petrosian/Common/RowBlocks.h"
+#include "Petrosian/Common/ThreadPool.h"
+
+using namespace Petrosian;
+
+namespace {
+
+static const size_t NITEMS = 1000;
+
+// Sum of the rows between y0 and y1, with terms of very different magnitude so the order matters
+double sumRows(int y0, int y1) {
+  double sum = 0.;
+  for (int y = y0; y <= y1; ++y) {
+    sum += std::exp(std::sin(y * 0.37) * 20.);
+  }
+  return sum;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE (ThreadPool_test)
+
+//-----------------------------------------------------------------------------
+
+// Every index is visited exactly once, whatever the number of threads
+BOOST_AUTO_TEST_CASE(ParallelFor_test) {
+  for (unsigned nthreads : {0u, 1u, 2u, 4u, 8u}) {
+    ThreadPool pool(nthreads);
+    std::vector<std::atomic<int>> visits(NITEMS);
+    for (auto& v : visits) {
+      v = 0;
+    }
+    pool.parallelFor(NITEMS, [&visits](size_t i) { ++visits[i]; });
+    for (size_t i = 0; i < NITEMS; ++i) {
+      BOOST_CHECK_EQUAL(visits[i].load(), 1);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// Partial sums computed on the pool and combined in order do not depend on the number of threads
+BOOST_AUTO_TEST_CASE(ParallelForSum_test) {
+  std::vector<double> reference(NITEMS);
+  for (size_t i = 0; i < NITEMS; ++i) {
+    reference[i] = sumRows(i * 10, i * 10 + 9);
+  }
+
+  for (unsigned nthreads : {1u, 2u, 4u, 8u}) {
+    ThreadPool pool(nthreads);
+    std::vector<double> partials(NITEMS);
+    pool.parallelFor(NITEMS, [&partials](size_t i) { partials[i] = sumRows(i * 10, i * 10 + 9); });
+    BOOST_CHECK(partials == reference);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// Same for the blocks of RowBlocks, which are combined pairwise
+BOOST_AUTO_TEST_CASE(RowBlocksSum_test) {
+  auto reduce_rows = [](double& partial, int y0, int y1) { partial = sumRows(y0, y1); };
+  auto combine = [](double& a, double b) { a += b; };
+
+  std::vector<double> partials;
+  RowBlocks(1, nullptr).reduce(0, 9999, partials, reduce_rows, combine);
+  double reference = partials[0];
+
+  for (unsigned nthreads : {1u, 2u, 4u, 8u}) {
+    RowBlocks blocks(1, std::make_shared<ThreadPool>(nthreads));
+    for (int repeat = 0; repeat < 10; ++repeat) {
+      blocks.reduce(0, 9999, partials, reduce_rows, combine);
+      BOOST_CHECK_EQUAL(partials[0], reference);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// An exception thrown on the pool reaches the caller, after all the other indexes are done
+BOOST_AUTO_TEST_CASE(Exception_test) {
+  ThreadPool pool(4);
+  std::atomic<size_t> done{0};
+  BOOST_CHECK_THROW(pool.parallelFor(NITEMS, [&done](size_t i) {
+    if (i == NITEMS / 2) {
+      throw std::runtime_error("failed");
+    }
+    ++done;
+  }), std::runtime_error);
+  BOOST_CHECK_EQUAL(done.load(), NITEMS - 1);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
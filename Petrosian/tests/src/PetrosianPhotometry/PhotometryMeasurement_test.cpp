@@ -0,0 +1,106 @@
+/**
+ * @file tests/src/PetrosianPhotometry/PhotometryMeasurement_test.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+
+#include "Petrosian/PetrosianPhotometry/PhotometryMeasurement.h"
+
+using namespace Petrosian;
+using SourceXtractor::Flags;
+
+namespace {
+
+static const int WIDTH = 100, HEIGHT = 80;
+
+PhotometryMeasurement getMeasurement(const FrameSize& frame_size, const std::vector<double>& factors = {}) {
+  return PhotometryMeasurement(0, frame_size, 0., true, false, factors, 3.5, "", RowBlocks());
+}
+
+// Aperture whose stamp goes from (x0, y0) to (x1, y1)
+PhotometryAperture getAperture(int x0, int y0, int x1, int y1) {
+  PhotometryAperture aperture{};
+  aperture.m_min_pixel = {x0, y0};
+  aperture.m_max_pixel = {x1, y1};
+  return aperture;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE (PhotometryMeasurement_test)
+
+//-----------------------------------------------------------------------------
+
+// Only stamps entirely off the frame are skipped
+BOOST_AUTO_TEST_CASE(IsOutside_test) {
+  auto measurement = getMeasurement({WIDTH, HEIGHT});
+
+  BOOST_CHECK(!measurement.isOutside(getAperture(10, 10, 20, 20)));
+  // Crossing each border
+  BOOST_CHECK(!measurement.isOutside(getAperture(-5, 10, 0, 20)));
+  BOOST_CHECK(!measurement.isOutside(getAperture(10, -5, 20, 0)));
+  BOOST_CHECK(!measurement.isOutside(getAperture(WIDTH - 1, 10, WIDTH + 5, 20)));
+  BOOST_CHECK(!measurement.isOutside(getAperture(10, HEIGHT - 1, 20, HEIGHT + 5)));
+  // Covering the whole frame
+  BOOST_CHECK(!measurement.isOutside(getAperture(-10, -10, WIDTH + 10, HEIGHT + 10)));
+  // Off each border
+  BOOST_CHECK(measurement.isOutside(getAperture(-10, 10, -1, 20)));
+  BOOST_CHECK(measurement.isOutside(getAperture(10, -10, 20, -1)));
+  BOOST_CHECK(measurement.isOutside(getAperture(WIDTH, 10, WIDTH + 10, 20)));
+  BOOST_CHECK(measurement.isOutside(getAperture(10, HEIGHT, 20, HEIGHT + 10)));
+}
+
+//-----------------------------------------------------------------------------
+
+// If the size of the frame is not known, every source is measured
+BOOST_AUTO_TEST_CASE(UnknownFrame_test) {
+  auto measurement = getMeasurement({0, 0});
+  BOOST_CHECK(!measurement.isOutside(getAperture(-10, -10, -1, -1)));
+  BOOST_CHECK(!measurement.isOutside(getAperture(1000, 1000, 1010, 1010)));
+}
+
+//-----------------------------------------------------------------------------
+
+// Sources off the frame get NaN values flagged as OUTSIDE, for the main aperture and the additional ones
+BOOST_AUTO_TEST_CASE(ComputeOutside_test) {
+  auto measurement = getMeasurement({WIDTH, HEIGHT}, {1., 2., 3.});
+  std::vector<PetrosianPhotometry> apertures;
+  auto photometry = measurement.computeOutside(apertures);
+
+  BOOST_REQUIRE_EQUAL(apertures.size(), 3u);
+  apertures.push_back(photometry);
+  for (const auto& p : apertures) {
+    BOOST_CHECK(std::isnan(p.getFlux()));
+    BOOST_CHECK(std::isnan(p.getFluxError()));
+    BOOST_CHECK(std::isnan(p.getMag()));
+    BOOST_CHECK(std::isnan(p.getMagError()));
+    BOOST_CHECK(p.getFlags() == Flags::OUTSIDE);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,278 @@
+/**
+ * @file tests/src/PetrosianProfile/ProfileMeasurement_test.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <SEFramework/Image/VectorImage.h>
+#include <SEFramework/Source/SimpleSource.h>
+#include <SEImplementation/Plugin/IsophotalFlux/IsophotalFlux.h>
+#include <SEImplementation/Property/PixelCoordinateList.h>
+
+#include "Petrosian/PetrosianProfile/ProfileMeasurement.h"
+
+using namespace Petrosian;
+using SourceXtractor::SeFloat;
+using SourceXtractor::VectorImage;
+
+namespace {
+
+static const int WIDTH = 260, HEIGHT = 220;
+// Big enough for the binned search to only profile a narrow window at full resolution
+static const SourceEllipse ELLIPSE{1.f / 400.f, 1.f / 256.f, 0.0005f, 130.3f, 109.6f};
+static const int BINNING_AREA = 10000, BINNING_FACTOR = 4;
+// Several blocks of rows
+static const int BLOCK_AREA = 1000;
+
+// Gaussian with the second moments of the ellipse, so the Petrosian radius is that of getGaussianPetrosianRadius
+struct GaussianFixture {
+  std::shared_ptr<VectorImage<SeFloat>> m_image, m_variance;
+  ImageStamp m_stamp;
+
+  GaussianFixture() : m_image(VectorImage<SeFloat>::create(WIDTH, HEIGHT)),
+                      m_variance(VectorImage<SeFloat>::create(WIDTH, HEIGHT)) {
+    for (int y = 0; y < HEIGHT; ++y) {
+      for (int x = 0; x < WIDTH; ++x) {
+        double dx = x - ELLIPSE.m_centroid_x, dy = y - ELLIPSE.m_centroid_y;
+        double r2 = ELLIPSE.m_cxx * dx * dx + ELLIPSE.m_cyy * dy * dy + ELLIPSE.m_cxy * dx * dy;
+        m_image->at(x, y) = static_cast<SeFloat>(100. * std::exp(-r2 / 2));
+        m_variance->at(x, y) = 1.;
+      }
+    }
+    m_stamp.copy(m_image, m_variance, {0, 0}, {WIDTH - 1, HEIGHT - 1});
+  }
+
+  RadiusResult compute(int binning_area, const RowBlocks& blocks) const {
+    ProfileMeasurement measurement(0.2, 2., 0., RadiusSearchMode::ADAPTIVE, binning_area, BINNING_FACTOR,
+                                   0., 0., PETRO_NSIGMAS, blocks);
+    return measurement.compute(m_stamp, ELLIPSE, 2.f).getRadius();
+  }
+};
+
+// Exponential profile of scale EXPONENTIAL_SCALE, in units of a small ellipse. Its Petrosian radius is
+// beyond the default extent of the profile, and beyond its first extension
+static const int EXPONENTIAL_SIZE = 80;
+static const SourceEllipse SMALL_ELLIPSE{0.25f, 0.25f, 0.f, 40.3f, 39.6f};
+static const double EXPONENTIAL_SCALE = 2.7;
+
+struct ExponentialFixture {
+  std::shared_ptr<VectorImage<SeFloat>> m_image, m_variance;
+  ImageStamp m_stamp;
+  // Number of times a bigger stamp has been copied
+  int m_copies;
+
+  ExponentialFixture() : m_image(VectorImage<SeFloat>::create(EXPONENTIAL_SIZE, EXPONENTIAL_SIZE)),
+                         m_variance(VectorImage<SeFloat>::create(EXPONENTIAL_SIZE, EXPONENTIAL_SIZE)),
+                         m_copies(0) {
+    for (int y = 0; y < EXPONENTIAL_SIZE; ++y) {
+      for (int x = 0; x < EXPONENTIAL_SIZE; ++x) {
+        double dx = x - SMALL_ELLIPSE.m_centroid_x, dy = y - SMALL_ELLIPSE.m_centroid_y;
+        double r = std::sqrt(SMALL_ELLIPSE.m_cxx * dx * dx + SMALL_ELLIPSE.m_cyy * dy * dy);
+        m_image->at(x, y) = static_cast<SeFloat>(100. * std::exp(-r / EXPONENTIAL_SCALE));
+        m_variance->at(x, y) = 1.;
+      }
+    }
+    auto spans = ProfileMeasurement::getSpans(SMALL_ELLIPSE);
+    m_stamp.copy(m_image, m_variance, spans.getMinPixel(), spans.getMaxPixel());
+  }
+
+  RadiusResult compute(RadiusSearchMode mode, double max_nsigmas) {
+    ProfileMeasurement measurement(0.2, 2., 0., mode, 0, BINNING_FACTOR, 0., 0., max_nsigmas, RowBlocks());
+    auto copy_stamp = [this](ImageStamp& extension, const SourceXtractor::PixelCoordinate& min_pixel,
+                             const SourceXtractor::PixelCoordinate& max_pixel) -> uint64_t {
+      extension.copy(m_image, m_variance, min_pixel, max_pixel);
+      ++m_copies;
+      return 0;
+    };
+    return measurement.compute(m_stamp, SMALL_ELLIPSE, 2.f, nullptr, copy_stamp).getRadius();
+  }
+};
+
+// Source with the isophotal flux and the number of pixels the tiers are chosen by
+void setTierProperties(SourceXtractor::SourceInterface& source, double snr, int area) {
+  source.setProperty<SourceXtractor::IsophotalFlux>(snr * 10., 10., 0., 0.);
+  source.setProperty<SourceXtractor::PixelCoordinateList>(
+      std::vector<SourceXtractor::PixelCoordinate>(area, SourceXtractor::PixelCoordinate(0, 0)));
+}
+
+ProfileMeasurement getTierMeasurement(double tier_snr, int tier_area) {
+  return ProfileMeasurement(0.2, 2., 0., RadiusSearchMode::ADAPTIVE, 0, BINNING_FACTOR, tier_snr, tier_area,
+                            PETRO_NSIGMAS, RowBlocks());
+}
+
+bool hasFlag(const RadiusResult& result, RadiusFlags flag) {
+  return (result.m_flags & flag) == flag;
+}
+
+void checkSame(const RadiusResult& a, const RadiusResult& b) {
+  BOOST_CHECK(a.m_flags == b.m_flags);
+  BOOST_CHECK_CLOSE(a.m_petrosian_radius, b.m_petrosian_radius, 1e-6);
+  BOOST_CHECK_CLOSE(a.m_r50, b.m_r50, 1e-6);
+  BOOST_CHECK_CLOSE(a.m_r90, b.m_r90, 1e-6);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE (ProfileMeasurement_test)
+
+//-----------------------------------------------------------------------------
+
+// The full resolution profile finds the radius of the Gaussian
+BOOST_FIXTURE_TEST_CASE(Gaussian_test, GaussianFixture) {
+  auto result = compute(0, RowBlocks());
+  BOOST_CHECK(result.m_flags == RadiusFlags::NONE);
+  BOOST_CHECK_CLOSE(result.m_petrosian_radius, getGaussianPetrosianRadius(0.2), 1.);
+}
+
+//-----------------------------------------------------------------------------
+
+// Around the radius, the binned search profiles every pixel, so it finds the same radius, within the
+// tolerance of the search. The light radii below the window are read from the coarse profile
+BOOST_FIXTURE_TEST_CASE(Binned_test, GaussianFixture) {
+  auto reference = compute(0, RowBlocks());
+  auto binned = compute(BINNING_AREA, RowBlocks());
+  BOOST_CHECK(binned.m_flags == reference.m_flags);
+  // The bisection stops within 1/8 of a step, and there are 20 steps over the profile
+  BOOST_CHECK_LE(std::abs(binned.m_petrosian_radius - reference.m_petrosian_radius), PETRO_NSIGMAS / 20 / 8);
+  BOOST_CHECK_CLOSE(binned.m_r50, reference.m_r50, 2.);
+  BOOST_CHECK_CLOSE(binned.m_r90, reference.m_r90, 2.);
+}
+
+//-----------------------------------------------------------------------------
+
+// Splitting the rows in blocks only changes the order of the sums
+BOOST_FIXTURE_TEST_CASE(Blocks_test, GaussianFixture) {
+  auto pool = std::make_shared<ThreadPool>(2);
+  for (int binning_area : {0, BINNING_AREA}) {
+    auto reference = compute(binning_area, RowBlocks());
+    checkSame(compute(binning_area, RowBlocks(BLOCK_AREA, nullptr)), reference);
+    checkSame(compute(binning_area, RowBlocks(BLOCK_AREA, pool)), reference);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// Without extension, the radius is not found within the default extent
+BOOST_FIXTURE_TEST_CASE(NotExtended_test, ExponentialFixture) {
+  auto result = compute(RadiusSearchMode::ADAPTIVE, PETRO_NSIGMAS);
+  BOOST_CHECK(hasFlag(result, RadiusFlags::NOT_FOUND));
+  BOOST_CHECK_EQUAL(m_copies, 0);
+}
+
+//-----------------------------------------------------------------------------
+
+// The profile is extended twice, up to 13.5, before the radius is found
+BOOST_FIXTURE_TEST_CASE(Extended_test, ExponentialFixture) {
+  for (auto mode : {RadiusSearchMode::LEGACY, RadiusSearchMode::ADAPTIVE}) {
+    m_copies = 0;
+    auto result = compute(mode, 20.);
+    BOOST_CHECK(!hasFlag(result, RadiusFlags::NOT_FOUND));
+    BOOST_CHECK_EQUAL(m_copies, 2);
+    // Rings go from kmin to 1.2 kmin, and the radius is at 1.1 kmin. It is beyond the rings that fit
+    // in the first extension, and within those of the second
+    BOOST_CHECK_GT(result.m_petrosian_radius, 9. / 1.2 * 1.1);
+    BOOST_CHECK_LT(result.m_petrosian_radius, 13.5 / 1.2 * 1.1);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// Once extended, the legacy search keeps its step: the radius is at the middle of a ring starting on a step
+BOOST_FIXTURE_TEST_CASE(ExtendedStep_test, ExponentialFixture) {
+  auto result = compute(RadiusSearchMode::LEGACY, 20.);
+  BOOST_REQUIRE(!hasFlag(result, RadiusFlags::NOT_FOUND));
+  double steps = result.m_petrosian_radius / 1.1 / (PETRO_NSIGMAS / 20);
+  BOOST_CHECK_SMALL(steps - std::round(steps), 1e-6);
+}
+
+//-----------------------------------------------------------------------------
+
+// The extension stops at the configured extent, even if the radius has not been found
+BOOST_FIXTURE_TEST_CASE(ExtensionLimit_test, ExponentialFixture) {
+  auto result = compute(RadiusSearchMode::ADAPTIVE, 8.);
+  BOOST_CHECK(hasFlag(result, RadiusFlags::NOT_FOUND));
+  BOOST_CHECK_EQUAL(m_copies, 1);
+}
+
+//-----------------------------------------------------------------------------
+
+// Sources below the isophotal SNR threshold are faint, and only them
+BOOST_AUTO_TEST_CASE(TierSnr_test) {
+  auto measurement = getTierMeasurement(5., 0);
+  SourceXtractor::SimpleSource below, at, above;
+  setTierProperties(below, 4.9, 100);
+  setTierProperties(at, 5., 100);
+  setTierProperties(above, 5.1, 1);
+  BOOST_CHECK(measurement.isFaint(below));
+  BOOST_CHECK(!measurement.isFaint(at));
+  BOOST_CHECK(!measurement.isFaint(above));
+}
+
+//-----------------------------------------------------------------------------
+
+// Sources with fewer detected pixels than the area threshold are faint, and only them
+BOOST_AUTO_TEST_CASE(TierArea_test) {
+  auto measurement = getTierMeasurement(0., 10);
+  SourceXtractor::SimpleSource below, at, above;
+  setTierProperties(below, 100., 9);
+  setTierProperties(at, 100., 10);
+  setTierProperties(above, 1., 11);
+  BOOST_CHECK(measurement.isFaint(below));
+  BOOST_CHECK(!measurement.isFaint(at));
+  BOOST_CHECK(!measurement.isFaint(above));
+}
+
+//-----------------------------------------------------------------------------
+
+// Without thresholds, no source is faint, and the properties they depend on are not asked for
+BOOST_AUTO_TEST_CASE(TierDisabled_test) {
+  auto measurement = getTierMeasurement(0., 0);
+  SourceXtractor::SimpleSource source;
+  BOOST_CHECK(!measurement.isFaint(source));
+}
+
+//-----------------------------------------------------------------------------
+
+// Faint sources get the estimated radii, without searching any ring nor visiting any pixel
+BOOST_AUTO_TEST_CASE(MeasureFaint_test) {
+  for (auto measurement : {getTierMeasurement(5., 0), getTierMeasurement(0., 10)}) {
+    SourceXtractor::SimpleSource source;
+    measurement.measureFaint(source);
+
+    const auto& profile = source.getProperty<PetrosianProfileRadii>();
+    const auto& radius = profile.getRadius();
+    BOOST_CHECK(radius.m_flags == RadiusFlags::ESTIMATED);
+    BOOST_CHECK_EQUAL(radius.m_rings, 0u);
+    BOOST_CHECK_EQUAL(radius.m_petrosian_radius, getGaussianPetrosianRadius(0.2));
+    BOOST_CHECK_EQUAL(profile.getCost().m_pixels, 0u);
+    BOOST_CHECK(std::isinf(profile.getNeighbourRadius()));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,132 @@
+/**
+ * @file tests/src/PetrosianRadius/RadiusMeasurement_test.cpp
+ * @date 17/10/26
+ * @author agent
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+
+#include "Petrosian/PetrosianProfile/GrowthCurve.h"
+#include "Petrosian/PetrosianRadius/RadiusMeasurement.h"
+
+using namespace Petrosian;
+
+namespace {
+
+static const unsigned NBINS = 2048;
+
+// Profile of a Gaussian of unit σ, which encloses 1 - exp(-r^2 / 2) of its flux within r
+CumulativeProfile getGaussianProfile(double max_radius) {
+  CumulativeProfile profile(max_radius, NBINS);
+  double bin_width = max_radius * max_radius / NBINS;
+  for (unsigned i = 0; i < NBINS; ++i) {
+    double r2 = i * bin_width;
+    profile.add(r2 + bin_width / 2, std::exp(-r2 / 2) - std::exp(-(r2 + bin_width) / 2), bin_width);
+  }
+  profile.accumulate();
+  return profile;
+}
+
+// Radius enclosing a fraction of the flux of the Gaussian within max_radius
+double getGaussianRadius(double fraction, double max_radius) {
+  return std::sqrt(-2 * std::log1p(fraction * std::expm1(-max_radius * max_radius / 2)));
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE (RadiusMeasurement_test)
+
+//-----------------------------------------------------------------------------
+
+// On the profile of a Gaussian, the radii are those solved analytically for a source that is not profiled
+BOOST_AUTO_TEST_CASE(Gaussian_test) {
+  auto profile = getGaussianProfile(8.);
+  for (auto mode : {RadiusSearchMode::LEGACY, RadiusSearchMode::ADAPTIVE}) {
+    RadiusMeasurement measurement(0.2, 2., 0., mode);
+    auto result = measurement.measure(GrowthCurve(profile, 0., nullptr));
+    auto expected = measurement.estimate();
+
+    BOOST_CHECK(result.m_flags == RadiusFlags::NONE);
+    // The legacy search walks the start of the ring in steps of 1/20 of PETRO_NSIGMAS, and the radius is
+    // at the middle of the ring, 1.1 times further, so it can only be that close
+    if (mode == RadiusSearchMode::LEGACY) {
+      BOOST_CHECK_LE(std::abs(result.m_petrosian_radius - expected.m_petrosian_radius), PETRO_NSIGMAS / 20 * 1.1);
+    }
+    else {
+      BOOST_CHECK_CLOSE(result.m_petrosian_radius, expected.m_petrosian_radius, 1.);
+    }
+    BOOST_CHECK_CLOSE(result.m_r50, expected.m_r50, 0.1);
+    BOOST_CHECK_CLOSE(result.m_r90, expected.m_r90, 0.1);
+    BOOST_CHECK_GT(result.m_rings, 0u);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// The light radii enclose a fraction of the flux within the aperture, so they grow with it
+BOOST_AUTO_TEST_CASE(Aperture_test) {
+  auto profile = getGaussianProfile(8.);
+  for (double minrad : {3., 4., 5., 6.}) {
+    RadiusMeasurement measurement(0.2, 1., minrad, RadiusSearchMode::ADAPTIVE);
+    auto result = measurement.measure(GrowthCurve(profile, 0., nullptr));
+    double aperture_radius = measurement.getApertureRadius(result.m_petrosian_radius);
+
+    BOOST_CHECK_EQUAL(aperture_radius, minrad);
+    BOOST_CHECK_CLOSE(result.m_r50, getGaussianRadius(0.5, aperture_radius), 0.1);
+    BOOST_CHECK_CLOSE(result.m_r90, getGaussianRadius(0.9, aperture_radius), 0.1);
+    BOOST_CHECK_GT(result.m_r90 / result.m_r50, 1.);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// If the aperture goes beyond the profile, the light radii are measured within the profile, and flagged
+BOOST_AUTO_TEST_CASE(Truncated_test) {
+  auto profile = getGaussianProfile(3.);
+  RadiusMeasurement measurement(0.2, 2., 0., RadiusSearchMode::ADAPTIVE);
+  auto result = measurement.measure(GrowthCurve(profile, 0., nullptr));
+
+  BOOST_CHECK(measurement.getApertureRadius(result.m_petrosian_radius) > profile.getMaxRadius());
+  BOOST_CHECK((result.m_flags & RadiusFlags::TRUNCATED) == RadiusFlags::TRUNCATED);
+  BOOST_CHECK_CLOSE(result.m_r50, getGaussianRadius(0.5, profile.getMaxRadius()), 0.1);
+  BOOST_CHECK_CLOSE(result.m_r90, getGaussianRadius(0.9, profile.getMaxRadius()), 0.1);
+}
+
+//-----------------------------------------------------------------------------
+
+// Without any positive flux, the light radii are not defined
+BOOST_AUTO_TEST_CASE(NoFlux_test) {
+  CumulativeProfile profile(8., NBINS);
+  profile.add(1., -1.);
+  profile.accumulate();
+  RadiusMeasurement measurement(0.2, 2., 3.5, RadiusSearchMode::ADAPTIVE);
+  auto result = measurement.measure(GrowthCurve(profile, 0., nullptr));
+
+  BOOST_CHECK(std::isnan(result.m_r50));
+  BOOST_CHECK(std::isnan(result.m_r90));
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()